@@ -0,0 +1,101 @@
+// Throughput of passing assertions in a tight loop, compared to a bare `if`.
+// Run with --bench; items/s is assertions per second.
+// (built with -O2 and without sanitizers, see CMakeLists.txt)
+
+#include "../simple_test.h"
+
+#include <numeric>
+#include <vector>
+
+static constexpr size_t kSize = 1 << 16;
+
+static std::vector<int> make_values() {
+  std::vector<int> xs(kSize);
+  std::iota(xs.begin(), xs.end(), 0);
+  return xs;
+}
+
+BENCHMARK(assertions, bare_if) {
+  const auto xs = make_values(), ys = make_values();
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    for (size_t i = 0; i != kSize; ++i) {
+      if (xs[i] != ys[i]) { ADD_FAILURE(); }
+    }
+    simple_test::clobber_memory();
+  }
+}
+
+BENCHMARK(assertions, expect_eq) {
+  const auto xs = make_values(), ys = make_values();
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    for (size_t i = 0; i != kSize; ++i) {
+      EXPECT_EQ(xs[i], ys[i]);
+    }
+    simple_test::clobber_memory();
+  }
+}
+
+BENCHMARK(assertions, assert_lt) {
+  const auto xs = make_values();
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    for (size_t i = 0; i != kSize; ++i) {
+      ASSERT_LT(xs[i], static_cast<int>(kSize));
+    }
+    simple_test::clobber_memory();
+  }
+}
+
+BENCHMARK(assertions, expect_true) {
+  const auto xs = make_values();
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    for (size_t i = 0; i != kSize; ++i) {
+      EXPECT_TRUE(xs[i] >= 0);
+    }
+    simple_test::clobber_memory();
+  }
+}
+
+BENCHMARK(assertions, expect_near) {
+  std::vector<double> xs(kSize, 1.0);
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    for (size_t i = 0; i != kSize; ++i) {
+      EXPECT_NEAR(xs[i], 1.0, 1e-9);
+    }
+    simple_test::clobber_memory();
+  }
+}
+
+BENCHMARK(assertions, expect_all_near) {
+  std::vector<double> xs(kSize, 1.0), ys(kSize, 1.0 + 1e-12);
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    EXPECT_ALL_NEAR(xs, ys, 1e-9, 1e-9);
+    simple_test::clobber_memory();
+  }
+}
+
+BENCHMARK(assertions, expect_all_near_ulp) {
+  std::vector<double> xs(kSize, 1.0), ys(kSize, 1.0 + 1e-12);
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    EXPECT_ALL_NEAR_ULP(xs, ys, 10000);
+    simple_test::clobber_memory();
+  }
+}
+
+// the whole buffer at once, compared as memory
+BENCHMARK(assertions, expect_range_eq) {
+  const auto xs = make_values(), ys = make_values();
+  state.set_items_per_iteration(kSize);
+  for (auto _ : state) {
+    EXPECT_RANGE_EQ(xs, ys);
+    simple_test::clobber_memory();
+  }
+}
+
+TESTING_MAIN()
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Measures the compile time of a test file including
+# the whole simple_test.h versus just simple_test_core.h.
+# Usage: examples/bench_compile_time.sh [number of files]  (CXX, CXXFLAGS are respected)
+
+set -e
+
+cd "$(dirname "$0")/.."
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:--O1}
+N=${1:-20}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# a typical test file: a few tests with assertions
+make_test() {
+  cat > "$TMP/test_$1.cpp" <<EOT
+#include "$PWD/$2"
+#include <vector>
+TEST(suite_$1, vector) {
+  std::vector<int> xs(10, 1);
+  EXPECT_EQ(xs.size(), 10u);
+  ASSERT_NE(xs.front(), 0);
+}
+TEST(suite_$1, strings) {
+  EXPECT_STREQ("hello", "hello");
+  EXPECT_NEAR(1.0, 1.05, 0.1);
+}
+EOT
+}
+
+measure() {
+  header=$1
+  i=0
+  while [ $i -lt "$N" ]; do make_test $i "$header"; i=$((i + 1)); done
+  lines=$($CXX -std=c++20 -E "$TMP/test_0.cpp" | wc -l)
+  start=$(date +%s.%N)
+  i=0
+  while [ $i -lt "$N" ]; do
+    $CXX -std=c++20 $CXXFLAGS -c "$TMP/test_$i.cpp" -o "$TMP/test_$i.o"
+    i=$((i + 1))
+  done
+  end=$(date +%s.%N)
+  awk -v h="$header" -v n="$N" -v s="$start" -v e="$end" -v l="$lines" \
+      'BEGIN { printf "%-20s %d files, %6.1f ms per file, %d preprocessed lines\n", h ":", n, (e - s) * 1000 / n, l }'
+}
+
+measure simple_test.h
+measure simple_test_core.h
@@ -0,0 +1,45 @@
+// Measures the cost of test selection as the number of tests grows.
+// Names are generated, so there are no real tests here.
+
+#include "../simple_test.h"
+#include <chrono>
+#include <cstdio>
+
+int main() {
+  const char* few_patterns[] = {"suite_1*.test_*7"};
+  const char* many_patterns[] = {
+    "suite_1*.test_*7", "suite_2?.*", "*.test_12?", "suite_3*.*_5",
+    "suite_4.test_4*", "suite_5*.test_??", "*_6.*", "suite_7*.test_7*",
+    "suite_8?.*1", "*.test_9*9", "-suite_1?.*", "-*.test_1",
+  };
+
+  auto measure = [](size_t num_tests, const auto& patterns) {
+    std::vector<std::string> suites, names;
+    for (size_t i = 0; i != num_tests; ++i) {
+      suites.push_back("suite_" + std::to_string(i / 100));
+      names.push_back("test_" + std::to_string(i % 100));
+    }
+
+    simple_test::glob_filter filter;
+    for (const char* p : patterns) {
+      if (p[0] == '-') filter.add(p + 1, true);
+      else filter.add(p);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t selected = 0;
+    for (size_t i = 0; i != num_tests; ++i) {
+      selected += filter(suites[i].c_str(), names[i].c_str());
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("%8zu tests, %2zu patterns: %8.3f ms, %6.1f ns/test, %zu selected\n",
+        num_tests, std::size(patterns), elapsed.count(),
+        elapsed.count() * 1e6 / num_tests, selected);
+  };
+
+  for (size_t num_tests : {1000, 10000, 50000, 200000}) {
+    measure(num_tests, few_patterns);
+    measure(num_tests, many_patterns);
+  }
+}
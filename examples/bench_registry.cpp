@@ -0,0 +1,70 @@
+// Measures the startup cost of huge generated test sets:
+// registration (before main), building the registry and selecting the tests to run,
+// with `enabled` evaluated eagerly at registration or lazily for selected tests only.
+// Tests are registered at runtime, so there are no real tests here.
+
+#include "../simple_test.h"
+#include <chrono>
+#include <cstdio>
+
+// stands for a condition like "is the hardware available"
+static bool expensive_condition() {
+  unsigned x = 0;
+  for (unsigned i = 0; i != 1000; ++i) {
+    x += i * i;
+    simple_test::do_not_optimize(x);
+  }
+  return x != 0;
+}
+
+static void dummy_test() {}
+
+int main() {
+  using clock = std::chrono::steady_clock;
+  auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+  auto measure = [&](size_t num_tests, bool lazy) {
+    std::vector<std::string> suites, names;
+    for (size_t i = 0; i != num_tests; ++i) {
+      suites.push_back("suite_" + std::to_string(i % 1000));  // suites are interleaved
+      names.push_back("test_" + std::to_string(i / 1000));
+    }
+
+    // count() goes on growing, so the registry knows it shall be rebuilt
+    simple_test::TestCase::first() = simple_test::TestCase::last() = nullptr;
+    std::deque<simple_test::TestCase> tests;
+
+    auto start = clock::now();
+    for (size_t i = 0; i != num_tests; ++i) {
+      if (lazy) {
+        tests.emplace_back(suites[i].c_str(), names[i].c_str(), dummy_test,
+            +[] { return simple_test::test_preset(expensive_condition()); });
+      } else {
+        tests.emplace_back(suites[i].c_str(), names[i].c_str(), dummy_test, expensive_condition());
+      }
+    }
+    auto registered = clock::now();
+
+    const auto& registry = simple_test::test_registry::instance();
+    auto indexed = clock::now();
+
+    simple_test::glob_filter filter;
+    filter.add("suite_12?.*");
+    size_t selected = 0;
+    for (simple_test::TestCase* t : registry.tests) {
+      selected += filter(t->m_suite, t->m_name) && t->is_enabled();
+    }
+    auto filtered = clock::now();
+
+    printf("%8zu tests, %-5s: register %9.3f ms, index %8.3f ms, select %8.3f ms, %zu selected\n",
+        num_tests, lazy ? "lazy" : "eager",
+        ms(registered - start), ms(indexed - registered), ms(filtered - indexed), selected);
+  };
+
+  for (size_t num_tests : {10000, 50000, 200000}) {
+    measure(num_tests, false);
+    measure(num_tests, true);
+  }
+
+  simple_test::TestCase::first() = simple_test::TestCase::last() = nullptr;
+}
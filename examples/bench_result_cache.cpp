@@ -0,0 +1,53 @@
+// Measures the result cache of huge test sets: saving the results of a run,
+// loading them at the start of the next one and looking up each test.
+// Tests are made at runtime (and not registered), so there are no real tests here.
+
+#include "../simple_test.h"
+#include <chrono>
+#include <cstdio>
+
+int main() {
+  using clock = std::chrono::steady_clock;
+  auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+  const std::string path = "bench_result_cache.tmp.cache";
+
+  for (size_t num_tests : {10000, 100000, 1000000}) {
+    std::vector<std::string> suites, names;
+    for (size_t i = 0; i != num_tests; ++i) {
+      suites.push_back("suite_" + std::to_string(i % 1000));
+      names.push_back("test_" + std::to_string(i / 1000));
+    }
+    std::deque<simple_test::TestCase> tests;
+    for (size_t i = 0; i != num_tests; ++i) {
+      tests.emplace_back(suites[i].c_str(), names[i].c_str(), +[] {});
+      tests.back().m_wall_ns = static_cast<double>(i);
+    }
+    simple_test::TestCase::first() = simple_test::TestCase::last() = nullptr;
+    remove(path.c_str());
+
+    auto start = clock::now();
+    {
+      std::vector<simple_test::result_cache::entry> fresh;
+      for (size_t i = 0; i != num_tests; ++i) {
+        fresh.push_back(simple_test::result_cache::record(tests[i], i % 7 != 0));
+      }
+      simple_test::result_cache().save(path, std::move(fresh));
+    }
+    auto saved = clock::now();
+
+    simple_test::result_cache cache;
+    cache.load(path);
+    auto loaded = clock::now();
+
+    size_t passed = 0, failed = 0;
+    for (const simple_test::TestCase& t : tests) {
+      passed += cache.passed_here(t);
+      failed += cache.failed_before(t);
+    }
+    auto looked_up = clock::now();
+
+    printf("%8zu tests: save %8.3f ms, load %8.3f ms, look up all %8.3f ms (%zu passed, %zu failed)\n",
+        num_tests, ms(saved - start), ms(loaded - saved), ms(looked_up - loaded), passed, failed);
+  }
+  remove(path.c_str());
+}
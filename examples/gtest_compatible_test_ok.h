@@ -80,3 +80,38 @@ TEST(simple_test, exceptions) {
   ASSERT_ANY_THROW(throw std::out_of_range("ahaha"));
   ASSERT_NO_THROW({});
 }
+
+// the dataset is made once for the suite, and only if some of its tests run
+class shared_dataset : public testing::Test {
+protected:
+  static std::vector<int>* data;
+  static int suites_set_up;
+
+  static void SetUpTestSuite() {
+    data = new std::vector<int>(1000);
+    for (int i = 0; i != 1000; ++i) (*data)[i] = i;
+    ++suites_set_up;
+  }
+  static void TearDownTestSuite() {
+    delete data;
+    data = nullptr;
+    --suites_set_up;
+  }
+
+  int first = -1;
+  void SetUp() override { first = data->front(); }
+};
+std::vector<int>* shared_dataset::data = nullptr;
+int shared_dataset::suites_set_up = 0;
+
+TEST_F(shared_dataset, is_set_up_once) {
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(suites_set_up, 1);
+  EXPECT_EQ(first, 0);
+}
+
+TEST_F(shared_dataset, sum) {
+  long long sum = 0;
+  for (int x : *data) sum += x;
+  EXPECT_EQ(sum, 999 * 1000 / 2);
+}
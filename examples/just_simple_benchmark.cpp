@@ -0,0 +1,59 @@
+#include "../simple_test.h"
+
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <vector>
+
+BENCHMARK(memory, memcpy_64k) {
+  std::vector<char> src(65536, 'x'), dst(65536);
+  state.set_bytes_per_iteration(src.size());
+  for (auto _ : state) {
+    memcpy(dst.data(), src.data(), src.size());
+    simple_test::clobber_memory();
+  }
+  EXPECT_EQ(dst.back(), 'x');
+}
+
+BENCHMARK(containers, vector_push_back) {
+  state.set_items_per_iteration(1000);
+  for (auto _ : state) {
+    std::vector<int> xs;
+    for (int i = 0; i != 1000; ++i) xs.push_back(i);
+    simple_test::do_not_optimize(xs.data());
+  }
+}
+
+BENCHMARK(containers, map_insert) {
+  state.set_items_per_iteration(1000);
+  for (auto _ : state) {
+    std::map<int, int> xs;
+    for (int i = 0; i != 1000; ++i) xs[i * 7 % 1000] = i;
+    simple_test::do_not_optimize(xs);
+  }
+}
+
+BENCHMARK(DISABLED_containers, never) {
+  FAIL() << "disabled benchmark must not run";
+}
+
+// tests are not run with --bench, and benchmarks are not run without it
+TEST(containers, iota) {
+  std::vector<int> xs(10);
+  std::iota(xs.begin(), xs.end(), 0);
+  EXPECT_EQ(std::accumulate(xs.begin(), xs.end(), 0), 45);
+}
+
+// --compare-baseline fails a run only on a significant slowdown
+TEST(baseline, mann_whitney) {
+  std::vector<double> before = {100, 102, 98, 101, 99, 103, 97, 100, 101, 99};
+  std::vector<double> noisy = {101, 99, 103, 98, 100, 102, 97, 101, 100, 99};
+  std::vector<double> slower = {120, 118, 123, 119, 121, 122, 117, 120, 125, 119};
+  EXPECT_GT(simple_test::mann_whitney_p(before, noisy), 0.05);
+  EXPECT_LT(simple_test::mann_whitney_p(before, slower), 0.001);
+  EXPECT_GT(simple_test::mann_whitney_p(slower, before), 0.999);  // faster, not slower
+  EXPECT_EQ(simple_test::mann_whitney_p(before, {}), 1);
+  EXPECT_EQ(simple_test::mann_whitney_p({5, 5, 5}, {5, 5, 5}), 1);
+}
+
+TESTING_MAIN()
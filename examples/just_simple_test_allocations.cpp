@@ -0,0 +1,58 @@
+// the runner is included here, so the allocations are counted
+#define SIMPLE_TEST_COUNT_ALLOCATIONS
+#include "../simple_test.h"
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int sum(const std::vector<int>& xs) {
+  return std::accumulate(xs.begin(), xs.end(), 0);
+}
+
+TEST(allocations, hot_path_does_not_allocate) {
+  std::vector<int> xs(1000, 1);  // one allocation, outside of the checked block
+  int total = 0;
+  EXPECT_MAX_ALLOCS(0) {
+    total = sum(xs);
+  }
+  EXPECT_EQ(total, 1000);
+}
+
+TEST(allocations, reserved_vector) {
+  EXPECT_MAX_ALLOCS(1) {
+    std::vector<int> xs;
+    xs.reserve(100);
+    for (int i = 0; i != 100; ++i) xs.push_back(i);
+  }
+}
+
+TEST(allocations, no_leaks) {
+  auto p = std::make_unique<std::string>(100, 'x');
+  std::vector<std::unique_ptr<int>> ptrs;
+  for (int i = 0; i != 10; ++i) ptrs.push_back(std::make_unique<int>(i));
+  p.reset();
+  ptrs.clear();
+  ptrs.shrink_to_fit();
+  EXPECT_NO_LEAKS();
+}
+
+TEST(allocations, aligned) {
+  struct alignas(64) line { char data[64]; };
+  EXPECT_MAX_ALLOCS(1) {
+    auto p = std::make_unique<line>();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p.get()) % 64, 0u);
+  }
+  EXPECT_NO_LEAKS();
+}
+
+// allocations of other threads are counted by them, not by the test
+TEST(allocations, other_threads) {
+  EXPECT_MAX_ALLOCS(2) {  // the thread's state, and maybe its stack
+    std::thread([] { std::vector<int> xs(1000); }).join();
+  }
+}
+
+TESTING_MAIN()
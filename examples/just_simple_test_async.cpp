@@ -0,0 +1,88 @@
+#include "../simple_test.h"
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+simple_test::task<int> delayed(int value, std::chrono::milliseconds delay) {
+  co_await simple_test::sleep_for(delay);
+  co_return value;
+}
+
+simple_test::task<> write_later(int fd, std::string text) {
+  co_await simple_test::sleep_for(10ms);
+  ASSERT_EQ(write(fd, text.data(), text.size()), ssize_t(text.size()));
+}
+
+simple_test::task<std::string> read_some(int fd) {
+  co_await simple_test::readable(fd);
+  char buf[64];
+  ssize_t n = read(fd, buf, sizeof(buf));
+  ASSERT_GT(n, 0);
+  co_return std::string(buf, n);
+}
+
+}  // namespace
+
+ASYNC_TEST(async, sleep) {
+  const auto start = std::chrono::steady_clock::now();
+  co_await simple_test::sleep_for(20ms);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+}
+
+ASYNC_TEST(async, nested_tasks) {
+  int a = co_await delayed(1, 10ms);
+  int b = co_await delayed(2, 5ms);
+  EXPECT_EQ(a + b, 3);
+}
+
+ASYNC_TEST(async, pipe) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  auto writer = write_later(fds[1], "hello");
+  co_await writer;
+  EXPECT_EQ(co_await read_some(fds[0]), "hello");
+  close(fds[0]);
+  close(fds[1]);
+}
+
+ASYNC_TEST(async, future) {
+  std::future<int> answer = std::async(std::launch::async, [] {
+    std::this_thread::sleep_for(10ms);
+    return 42;
+  });
+  EXPECT_EQ(co_await simple_test::when_ready(answer), 42);
+}
+
+// these sleep 100 ms each, but take about 100 ms together
+ASYNC_TEST(async_interleaved, first) {
+  for (int i = 0; i != 10; ++i) {
+    co_await simple_test::sleep_for(10ms);
+    EXPECT_STREQ(simple_test::TestCase::current()->m_name, "first");
+  }
+}
+ASYNC_TEST(async_interleaved, second) {
+  for (int i = 0; i != 5; ++i) {
+    co_await simple_test::sleep_for(20ms);
+    EXPECT_STREQ(simple_test::TestCase::current()->m_name, "second");
+  }
+}
+ASYNC_TEST(async_interleaved, third) {
+  co_await simple_test::sleep_for(100ms);
+  EXPECT_STREQ(simple_test::TestCase::current()->m_name, "third");
+}
+
+ASYNC_TEST(async, DISABLED_never) {
+  FAIL();
+  co_return;
+}
+
+TESTING_MAIN()
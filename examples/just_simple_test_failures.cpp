@@ -1,6 +1,12 @@
 #include "../simple_test.h"
 #include <cassert>
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <list>
+#include <string>
+#include <thread>
 #include <vector>
 
 TEST(should_fail, vector_capacity) {
@@ -49,4 +55,82 @@ TEST(should_fail, strings) {
   EXPECT_EQ("aaa\x11", "aaa\x12") << simple_print::verbose("bbb\x13");
 }
 
+// 10 MB strings are printed partially, around the first difference
+TEST(should_fail, huge_strings) {
+  std::string a(10 << 20, 'x'), b = a;
+  b[5000000] = 'y';
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(std::vector<int>(100000, 1), std::vector<int>(100001, 1));
+}
+
+// the largest error and the histogram of errors
+TEST(should_fail, float_arrays) {
+  std::vector<float> xs(1 << 20, 1.0f), ys = xs;
+  ys[1000] = 1.001f;
+  ys[2000] = 1.1f;
+  ys[3000] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_ALL_NEAR(xs, ys, 1e-6, 1e-6);
+  EXPECT_ALL_NEAR_ULP(xs, ys, 4);
+  EXPECT_FLOAT_EQ(xs[0], ys[1000]);
+}
+
+// the first mismatch at [500000] of 2 is shown, with the neighbours
+TEST(should_fail, ranges) {
+  std::vector<int> xs(1 << 20), ys(1 << 20);
+  ys[500000] = 1;
+  ys[700000] = 2;
+  EXPECT_RANGE_EQ(xs, ys);
+  EXPECT_RANGE_EQ(std::list<int>({1, 2, 3}), std::vector<int>({1, 2}));
+  EXPECT_BYTES_EQ(xs.data(), ys.data(), xs.size() * sizeof(int));
+}
+
+// failures in threads are reported to the test; an assertion stops only its thread
+TEST(should_fail, threads) {
+  simple_test::test_thread worker([] {
+    ASSERT_EQ(1, 2) << "in a test_thread";
+    assert(false);  // unreachable
+  });
+  worker.join();
+  std::thread([] { EXPECT_EQ(3, 4) << "in a std::thread"; }).join();
+  STRESS(4, 1000) {
+    if (thread_index == 2) {
+      ASSERT_LT(iteration, 500u);
+    }
+  };
+}
+
+// shrinks to a 2-item vector, e.g. xs = {0, 1}
+PROPERTY(should_fail, sorted, (std::vector<int> xs)) {
+  EXPECT_TRUE(std::is_sorted(xs.begin(), xs.end()));
+}
+
+// the first test reports the failed set-up, the second one fails without running
+struct should_fail_set_up : simple_test::Test {
+  static void SetUpTestSuite() { ASSERT_EQ(1, 2) << "the dataset can't be loaded"; }
+};
+
+TEST_F(should_fail_set_up, first) {}
+TEST_F(should_fail_set_up, second) {}
+
+// each failure is reported by its own test, though they are resumed in turns
+simple_test::task<int> should_fail_later(std::chrono::milliseconds delay) {
+  co_await simple_test::sleep_for(delay);
+  throw std::runtime_error("in a nested coroutine");
+}
+ASYNC_TEST(should_fail, async_assertion) {
+  co_await simple_test::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_EQ(1, 2) << "after a sleep";
+}
+ASYNC_TEST(should_fail, async_exception) {
+  EXPECT_EQ(co_await should_fail_later(std::chrono::milliseconds(10)), 0);
+}
+ASYNC_TEST(should_fail, async_stuck) {
+  co_await std::suspend_always{};  // nothing resumes it
+}
+
+// the timeout is 100 ms; the run is aborted here (or the test is killed with --isolate)
+TEST(should_fail, hung, true, 100) {
+  for (;;) std::this_thread::sleep_for(std::chrono::seconds(1));
+}
+
 TESTING_MAIN()
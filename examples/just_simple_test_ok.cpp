@@ -1,5 +1,12 @@
 #include "../simple_test.h"
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(MUST_SKIP, some_disabled, false) {
   assert(false);  // unreachable
@@ -73,6 +80,53 @@ TEST(simple_test, compare_floats_implicitly) {
   EXPECT_FLOATCMP(pivot, >=, pivot + epsilon, epsilon);
 }
 
+TEST(simple_test, compare_ranges) {
+  std::vector<int> xs(1 << 20, 7);
+  std::vector<int> ys = xs;
+  EXPECT_RANGE_EQ(xs, ys);  // as memory
+  EXPECT_BYTES_EQ(xs.data(), ys.data(), xs.size() * sizeof(int));
+
+  const int arr[] = {1, 2, 3};
+  EXPECT_RANGE_EQ(std::list<long>({1, 2, 3}), arr);  // element by element
+  EXPECT_RANGE_EQ(std::string("abc"), std::vector<char>({'a', 'b', 'c'}));
+  EXPECT_RANGE_EQ(std::vector<double>(), std::list<double>());
+}
+
+TEST(simple_test, compare_float_arrays) {
+  std::vector<double> xs(1 << 20), ys(1 << 20);
+  for (size_t i = 0; i != xs.size(); ++i) {
+    xs[i] = std::sin(i * 0.001) - 0.5;
+    ys[i] = xs[i] + 1e-12 * xs[i];
+  }
+  EXPECT_ALL_NEAR(xs, ys, 1e-15, 1e-9);  // with values near zero and negative
+  EXPECT_ALL_NEAR_ULP(xs, ys, 100000);
+
+  const float fs[] = {1.0f, -2.5f, 0.0f};
+  const float gs[] = {std::nextafter(1.0f, 2.0f), -2.5f, -0.0f};
+  EXPECT_ALL_NEAR_ULP(fs, gs, 1);
+  EXPECT_FLOAT_EQ(fs[0], gs[0]);
+  EXPECT_DOUBLE_EQ(0.1 + 0.2, 0.3);
+}
+
+TEST(simple_test, within_timeout, true, 1000) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+TEST(threads, stress) {
+  std::atomic<int> counter{0};
+  STRESS(4, 1000) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  };
+  EXPECT_EQ(counter.load(), 4000);
+}
+
+TEST(threads, assertions) {
+  simple_test::test_thread worker([] {
+    EXPECT_EQ(1 + 1, 2);
+    ASSERT_TRUE(true);
+  });
+}
+
 TEST(gtest_like, variety) {
   EXPECT_EQ(123, 123);
   EXPECT_STREQ("aaa\0bbb", "aaa\0ccc");
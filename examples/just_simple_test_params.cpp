@@ -0,0 +1,45 @@
+#include "../simple_test.h"
+
+#include <string>
+#include <tuple>
+
+struct numbers : simple_test::TestWithParam<int> {
+  int squared = 0;
+  void SetUp() override { squared = GetParam() * GetParam(); }
+};
+
+TEST_P(numbers, square_is_not_negative) {
+  EXPECT_GE(squared, 0);
+}
+
+TEST_P(numbers, square_is_not_less) {
+  EXPECT_GE(squared, GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(small, numbers, simple_test::values(0, 1, 2, 3));
+INSTANTIATE_TEST_SUITE_P(big, numbers, simple_test::range(1000, 46000, 5000));
+
+struct pairs : simple_test::TestWithParam<std::tuple<int, std::string>> {};
+
+TEST_P(pairs, repeat) {
+  const auto& [n, s] = GetParam();
+  EXPECT_EQ(std::string(n, s[0]).size(), static_cast<size_t>(n));
+}
+
+INSTANTIATE_TEST_SUITE_P(all, pairs,
+    simple_test::combine(simple_test::range(0, 3), simple_test::values("a", "bc")));
+
+// lines are read when their tests run, not beforehand
+struct source_lines : simple_test::TestWithParam<std::string> {};
+
+TEST_P(source_lines, not_too_long) {
+  EXPECT_LE(GetParam().size(), 120U) << GetParam();
+}
+
+INSTANTIATE_TEST_SUITE_P(this_file, source_lines, simple_test::lines_of(__FILE__));
+
+TEST_P(numbers, DISABLED_never) {
+  FAIL() << "disabled test must not run";
+}
+
+TESTING_MAIN()
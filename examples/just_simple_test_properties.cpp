@@ -0,0 +1,61 @@
+#include "../simple_test.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+PROPERTY(properties, reverse_twice, (std::vector<int> xs)) {
+  std::vector<int> ys(xs.rbegin(), xs.rend());
+  std::reverse(ys.begin(), ys.end());
+  EXPECT_EQ(xs, ys);
+}
+
+PROPERTY(properties, concat_size, (const std::string& a, const std::string& b)) {
+  EXPECT_EQ((a + b).size(), a.size() + b.size());
+}
+
+PROPERTY(properties, sort_is_ordered, (std::vector<short> xs, bool descending)) {
+  if (descending) {
+    std::sort(xs.begin(), xs.end(), std::greater<short>());
+    EXPECT_TRUE(std::is_sorted(xs.rbegin(), xs.rend()));
+  } else {
+    std::sort(xs.begin(), xs.end());
+    EXPECT_TRUE(std::is_sorted(xs.begin(), xs.end()));
+  }
+}
+
+PROPERTY(properties, abs_is_not_negative, (double x)) {
+  EXPECT_GE(std::abs(x), 0.0);
+}
+
+// a user type: specialize simple_test::arbitrary
+struct point {
+  int x, y;
+};
+
+std::ostream& operator<<(std::ostream& ost, const point& p) {
+  return ost << "{" << p.x << ", " << p.y << "}";
+}
+
+template<> struct simple_test::arbitrary<point> {
+  static point generate(property_rng& rng, size_t size) {
+    return {arbitrary<int>::generate(rng, size), arbitrary<int>::generate(rng, size)};
+  }
+  static std::vector<point> shrink(const point& p) {
+    std::vector<point> ps;
+    for (int x : arbitrary<int>::shrink(p.x)) ps.push_back({x, p.y});
+    for (int y : arbitrary<int>::shrink(p.y)) ps.push_back({p.x, y});
+    return ps;
+  }
+};
+
+PROPERTY(properties, manhattan_is_symmetric, (point a, point b)) {
+  auto distance = [](point p, point q) { return std::abs(long(p.x) - q.x) + std::abs(long(p.y) - q.y); };
+  EXPECT_EQ(distance(a, b), distance(b, a));
+}
+
+PROPERTY(properties, DISABLED_never, (int)) {
+  FAIL();
+}
+
+TESTING_MAIN()
@@ -0,0 +1,5 @@
+// The same tests as test_using_simple_test_ok.cpp,
+// but this file includes just the assertions, and main() is in simple_test_main.cpp
+#include "../simple_test_core.h"
+#include <iostream>  // the tests print to std::cout
+#include "gtest_compatible_test_ok.h"
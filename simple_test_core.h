@@ -0,0 +1,2384 @@
+#pragma once
+
+// Author: Nikolay Merkin <merkin@mail.ru> <nickolay.merkin@gmail.com>
+// https://github.com/cpp-practice/simple-test
+// https://github.com/nickolaym/simple_test
+
+// Assertions and registration of tests: include it in the test files.
+// The runner (and main) lives in simple_test_runner.h, which shall be included in one file only,
+// e.g. simple_test_main.cpp; or include simple_test.h to get both.
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// passing assertions shall cost as little as a bare `if`,
+// so they are inlined, and the reporting is moved out of the way
+#if defined(__GNUC__) || defined(__clang__)
+  #define SIMPLE_TEST_ALWAYS_INLINE [[gnu::always_inline]] inline
+  #define SIMPLE_TEST_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+  #define SIMPLE_TEST_ALWAYS_INLINE __forceinline
+  #define SIMPLE_TEST_COLD __declspec(noinline)
+#else
+  #define SIMPLE_TEST_ALWAYS_INLINE inline
+  #define SIMPLE_TEST_COLD
+#endif
+
+// some tests interact with std::cout, so let's use separate stream
+// (it is buffered per thread and goes to stderr, see simple_print::output_stream)
+#define OUTPUT_STREAM() simple_print::output_stream()
+
+namespace simple_print {
+
+static constexpr const char* bar = "-------------------";
+static constexpr const char* barbar = "===================";
+static constexpr const char* red = "\x1b[31m";
+static constexpr const char* green = "\x1b[32m";
+static constexpr const char* yellow = "\x1b[33m";
+static constexpr const char* blue = "\x1b[34m";
+static constexpr const char* normal = "\x1b[0m";
+
+// Output is collected in a per-thread buffer and is written out at once
+// when a test finishes (or the program crashes), instead of a write() per line.
+
+// where the collected output goes; it must not allocate, as it is called from signal handlers
+using output_sink_func = void (*)(const char* data, size_t size);
+
+inline bool write_all(int fd, const void* data, size_t size) {
+  for (auto p = static_cast<const char*>(data); size; ) {
+    ssize_t n = write(fd, p, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+inline void write_to_stderr(const char* data, size_t size) {
+  write_all(STDERR_FILENO, data, size);
+}
+
+inline output_sink_func& output_sink() {
+  static output_sink_func sink = write_to_stderr;
+  return sink;
+}
+
+// guards the sink, so outputs of different threads are not interleaved
+inline std::mutex& output_mutex() {
+  static std::mutex m;
+  return m;
+}
+
+// takes the collected text away to be written later (see async_writer),
+// returns false if it can't, so the caller shall write it by itself
+using output_handoff_func = bool (*)(std::string& text);
+
+inline output_handoff_func& output_handoff() {
+  static output_handoff_func handoff = nullptr;
+  return handoff;
+}
+
+struct output_buffer : std::streambuf {
+  std::string text;
+
+  ~output_buffer() override { flush(); }  // e.g. when the test calls exit()
+
+  int_type overflow(int_type c) override {
+    if (c != traits_type::eof()) text += traits_type::to_char_type(c);
+    return traits_type::not_eof(c);
+  }
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    text.append(s, n);
+    return n;
+  }
+  // std::endl and std::flush do not cause a write()
+  int sync() override { return 0; }
+
+  void flush() {
+    if (text.empty()) return;
+    if (output_handoff() && output_handoff()(text)) {
+      text = std::string();
+      return;
+    }
+    std::lock_guard<std::mutex> lock(output_mutex());
+    output_sink()(text.data(), text.size());
+    text.clear();
+  }
+
+  // no locks and no allocations here
+  void flush_on_crash() {
+    output_sink()(text.data(), text.size());
+    text.clear();
+  }
+};
+
+struct thread_output {
+  output_buffer buf;
+  std::ostream ost{&buf};
+
+  static thread_output& instance() {
+    thread_local thread_output out;
+    return out;
+  }
+};
+
+inline std::ostream& output_stream() { return thread_output::instance().ost; }
+
+// writes out the output collected by this thread
+inline void flush_output() { thread_output::instance().buf.flush(); }
+
+struct colored_cout_line {
+  static bool is_colored() {
+    static const bool tty = (isatty(fileno(stdout)));
+    return tty;
+  }
+
+  explicit colored_cout_line(const char* color) {
+    if (is_colored()) OUTPUT_STREAM() << color;
+  }
+  colored_cout_line(colored_cout_line const&) = delete;
+  ~colored_cout_line() {
+    if (is_colored()) OUTPUT_STREAM() << normal;
+    OUTPUT_STREAM() << '\n';
+  }
+
+  std::ostream& ost() const { return OUTPUT_STREAM(); }
+  std::ostream& operator << (const auto& arg) { return ost() << arg; }
+};
+
+// failed values are printed up to this many characters (0 - without limit), see --print-width
+inline size_t& max_print_width() {
+  static size_t width = 200;
+  return width;
+}
+
+// quoted and escaped; plain characters are written in runs, not one by one
+inline void verbose_print_chars(std::ostream& ost, const char* s, size_t n) {
+  static constexpr char hex_digits[] = "0123456789abcdef";
+  ost << '"';
+  const char* run = s;
+  for (const char* end = s + n; s != end; ++s) {
+    const char c = *s;
+    if (!(c >= 0 && c < 32)) continue;
+    ost.write(run, s - run);
+    run = s + 1;
+    if (c == '\n') ost << "\\n";
+    else if (c == '\r') ost << "\\r";
+    else if (c == '\t') ost << "\\t";
+    else ost << "\\x" << hex_digits[c >> 4] << hex_digits[c & 15];
+  }
+  ost.write(run, s - run);
+  ost << '"';
+}
+
+// a string longer than max_print_width() is shown partially, around the position `at`:
+// [from..to) of n: "..."
+inline void verbose_print_string_at(std::ostream& ost, const char* s, size_t n, size_t at) {
+  const size_t width = max_print_width();
+  if (width == 0 || n <= width) return verbose_print_chars(ost, s, n);
+  const size_t from = std::min(at - std::min(at, width / 4), n - width);
+  ost << "[" << from << ".." << from + width << ") of " << n << ": ";
+  verbose_print_chars(ost, s + from, width);
+}
+
+// the shortest of 6 (15) or 9 (17) significant digits which reads back as the same value
+inline void verbose_print_float(std::ostream& ost, auto x) {
+  using F = decltype(x);
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*g", std::numeric_limits<F>::digits10, double(x));
+  if (F(strtod(buf, nullptr)) != x && x == x) {
+    snprintf(buf, sizeof(buf), "%.*g", std::numeric_limits<F>::max_digits10, double(x));
+  }
+  ost << buf;
+}
+
+inline void verbose_print_string(std::ostream& ost, const char* s, size_t n) {
+  verbose_print_string_at(ost, s, n, 0);
+}
+inline void verbose_print_string(std::ostream& ost, const std::string& arg) {
+  verbose_print_string(ost, arg.c_str(), arg.size());
+}
+inline void verbose_print_string(std::ostream& ost, std::string_view arg) {
+  verbose_print_string(ost, arg.data(), arg.size());
+}
+inline void verbose_print_string(std::ostream& ost, const char* arg) {
+  verbose_print_string(ost, arg, strlen(arg));
+}
+
+// counts characters written through it, to cut long containers
+struct counting_buf : std::streambuf {
+  std::streambuf* target;
+  size_t count = 0;
+  explicit counting_buf(std::streambuf* t) : target(t) {}
+  int overflow(int c) override {
+    if (c == traits_type::eof()) return traits_type::not_eof(c);
+    ++count;
+    return target->sputc(static_cast<char>(c));
+  }
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    count += n;
+    return target->sputn(s, n);
+  }
+};
+
+void verbose_print(std::ostream& ost, const auto& arg) {
+  using T = std::decay_t<decltype((arg))>;
+  if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+    verbose_print_string(ost, arg);
+  } else if constexpr (std::is_same_v<T, bool>) {
+    ost << std::boolalpha << arg;
+  } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+    verbose_print_float(ost, arg);
+  } else if constexpr (requires { ost << arg; }) {
+    ost << arg;
+  } else if constexpr (requires { arg.begin() != arg.end(); }) {  // containers
+    counting_buf counter(ost.rdbuf());
+    std::ostream cost(&counter);
+    cost.copyfmt(ost);
+    const size_t width = max_print_width();
+    size_t shown = 0;
+    cost << "{";
+    for (const auto& item : arg) {
+      if (width && counter.count >= width) {
+        size_t size = shown;
+        for (auto it = std::next(arg.begin(), shown); it != arg.end(); ++it) ++size;
+        cost << (shown ? ", " : "") << "... (" << size << " items)";
+        break;
+      }
+      if (shown++) cost << ", ";
+      verbose_print(cost, item);
+    }
+    cost << "}";
+  } else if constexpr (std::is_same_v<T, std::type_info>) {
+    ost << "typeid name = " << arg.name();
+  } else {
+    ost << typeid(T).name() << " [" << sizeof(T) << " bytes] @ " << &arg;
+  }
+}
+
+template<class T> struct verbose {
+  const T& arg; verbose(const T& a) : arg(a) {}
+  friend std::ostream& operator << (std::ostream& ost, const verbose& v) {
+    verbose_print(ost, v.arg);
+    return ost;
+  }
+};
+template<class T> verbose(const T&) -> verbose<T>;
+
+}  // namespace simple_print
+
+namespace simple_test {
+
+inline bool& show_green_assertions() {
+  thread_local bool flag = false;
+  return flag;
+}
+inline bool show_green_assertions(bool flag) {
+  bool old_flag = show_green_assertions();
+  show_green_assertions() = flag;
+  return old_flag;
+}
+
+struct assertion_fault {};  // out of std::exception hierarchy
+
+// micro-benchmarks
+
+// makes the compiler believe that the value is used
+template<class T> inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  const volatile char* p = reinterpret_cast<const volatile char*>(&value);
+  (void)*p;
+#endif
+}
+template<class T> inline void do_not_optimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : "+r,m"(value) : : "memory");
+#else
+  const volatile char* p = reinterpret_cast<const volatile char*>(&value);
+  (void)*p;
+#endif
+}
+
+// makes the compiler believe that all the memory is read and written
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// the runner calls the benchmark body several times with different numbers of iterations;
+// the body shall contain the measured loop: for (auto _ : state) { ... }
+struct benchmark_state {
+  using clock = std::chrono::steady_clock;
+
+  size_t m_iterations = 1;
+  clock::time_point m_start, m_stop;
+  // throughput, per iteration
+  uint64_t m_bytes = 0;
+  uint64_t m_items = 0;
+
+  size_t iterations() const { return m_iterations; }
+  void set_bytes_per_iteration(uint64_t n) { m_bytes = n; }
+  void set_items_per_iteration(uint64_t n) { m_items = n; }
+
+  struct [[maybe_unused]] value {};  // what the loop variable gets (unused)
+  struct iterator {
+    benchmark_state* state;
+    size_t left;
+    value operator*() const { return {}; }
+    void operator++() { --left; }
+    bool operator!=(const iterator&) {
+      if (left) [[likely]] return true;
+      state->m_stop = clock::now();
+      return false;
+    }
+  };
+  iterator begin() {
+    m_start = clock::now();
+    return {this, m_iterations};
+  }
+  iterator end() { return {this, 0}; }
+
+  double elapsed_ns() const { return std::chrono::duration<double, std::nano>(m_stop - m_start).count(); }
+};
+
+struct run_options {
+  int jobs = 1;  // number of threads (or child processes) to run tests on
+  bool isolate = false;  // run tests in child processes
+  bool async_output = false;  // write the output on a separate thread
+
+  double timeout_ms = 0;  // default timeout of a test (if set)
+
+  int slowest = 5;  // number of slowest tests and suites to report
+  double slow_threshold_ms = 0;  // highlight tests which run longer (if set)
+
+  bool bench = false;  // run benchmarks instead of tests
+  int bench_samples = 10;  // number of measurements of a benchmark
+  double bench_sample_ms = 50;  // duration of each measurement
+
+  std::vector<std::string> outputs;  // result files, "xml:path" or "json:path"
+
+  std::string cache_path;  // results of previous runs (if set)
+  bool failed_first = false;  // run the tests which failed last time first
+  bool only_changed = false;  // skip the tests which have passed with this binary
+  bool longest_first = true;  // order tests by durations of previous runs (if known)
+  int shard_index = 0;  // run only this part of the tests...
+  int shard_count = 1;  // ...of this many
+
+  unsigned counters = 0;  // performance counters to read, bit i for perf_counters::names[i]
+
+  int repeat = 1;  // run the tests this many times,
+  bool until_fail = false;  // or until an iteration fails,
+  double repeat_for_ms = 0;  // or for this long (if set), whichever comes first
+  bool repeating() const { return repeat > 1 || until_fail || repeat_for_ms > 0; }
+
+  std::string save_baseline;  // write the timings of the run here (if set)
+  std::string compare_baseline;  // compare the timings with these (if set)
+  double regression_threshold = 5;  // % of the median, which a test may be slower by
+  double significance = 0.05;  // p-value below which a change is significant
+};
+
+// a failed assertion (or another reason of failure), for the result files
+struct test_failure {
+  std::string file;  // empty if not an assertion
+  int line = 0;
+  std::string message;  // the report, without colors
+};
+
+// allocation accounting: counted by the replaced operator new and delete,
+// see SIMPLE_TEST_COUNT_ALLOCATIONS in simple_test_runner.h
+
+struct allocation_counters {
+  uint64_t allocs = 0;
+  uint64_t frees = 0;
+  uint64_t bytes = 0;  // allocated, as malloc_usable_size() tells
+  int64_t live = 0;  // bytes
+  int64_t peak = 0;  // of live bytes
+};
+
+// each thread counts its own allocations, so nothing is shared;
+// a test gets the counts of the thread which runs it
+inline allocation_counters& thread_allocations() {
+  thread_local allocation_counters counters;
+  return counters;
+}
+
+// set if the operators are replaced
+inline bool& allocation_counting() {
+  static bool on = false;
+  return on;
+}
+
+// performance counters of a test, see perf_counters in simple_test_runner.h
+inline constexpr size_t perf_counter_count = 6;
+
+struct TestCase;
+struct suite_fixture;
+
+// what the optional arguments of TEST give: TEST(suite, name, enabled, timeout_ms)
+struct test_preset {
+  bool enabled;
+  double timeout_ms;
+  test_preset(bool e = true, double t = 0) : enabled(e), timeout_ms(t) {}
+};
+// TEST wraps its optional arguments into a function,
+// so they are evaluated only if the test is selected to run
+using test_preset_func = test_preset (*)();
+
+template<class T = void> struct task;
+// body of an ASYNC_TEST, a coroutine
+using async_test_func = task<> (*)();
+
+struct param_source_base;
+// body of a TEST_P, called with the parameter at the index
+using param_test_func = void (*)(const param_source_base& source, size_t index);
+
+struct TestCase {
+  static TestCase*& first() { static TestCase* t = nullptr; return t; }
+  static TestCase*& last() { static TestCase* t = nullptr; return t; }
+  static size_t& count() { static size_t n = 0; return n; }  // number of registrations
+
+  // each thread runs its own test (or a part of it, see test_thread)
+  static TestCase*& current() { thread_local TestCase* t = nullptr; return t; }
+
+  // threads started by the test (not with test_thread) report to it if the tests run one by one
+  static std::atomic<TestCase*>& sole_running() { static std::atomic<TestCase*> t{nullptr}; return t; }
+  static TestCase* owner_of_this_thread() {
+    if (TestCase* t = current()) return t;
+    return sole_running();
+  }
+  // failures in threads of unknown tests (started not with test_thread in a parallel run)
+  static std::atomic<int>& unowned_failures() { static std::atomic<int> n{0}; return n; }
+
+  // guards the failures of the tests, which may come from several threads
+  static std::mutex& failures_mutex() { static std::mutex m; return m; }
+
+  // chain
+  TestCase* m_next = nullptr;
+  const char* m_suite;
+  const char* m_name;
+  void (*m_func)() = nullptr;
+  void (*m_bench_func)(benchmark_state&) = nullptr;  // set for benchmarks instead of m_func
+  async_test_func m_async_func = nullptr;  // set for ASYNC_TEST instead of m_func
+  test_preset_func m_preset = nullptr;  // evaluated on demand, see evaluate_preset()
+  bool m_enabled;
+  double m_timeout_ms = 0;  // overrides run_options::timeout_ms (if set)
+  // set for instances of TEST_P instead of m_func
+  param_test_func m_param_func = nullptr;
+  const param_source_base* m_param_source = nullptr;
+  size_t m_param_index = 0;
+
+  // preset
+  bool m_show_green_assertions = false;
+  suite_fixture* m_suite_fixture = nullptr;  // TEST_F: set-up shared by the tests of the suite
+
+  // result
+  bool m_called = false;
+  bool m_passed = false;
+  std::vector<test_failure> m_failures;  // taken by the result files when the test finishes
+  std::string m_thread_output;  // of the threads of the test, see test_thread
+  std::vector<double> m_bench_samples;  // ns per iteration
+  double m_wall_ns = 0;
+  double m_cpu_ns = 0;
+  allocation_counters m_alloc_start;  // of the thread, when the test has started
+  uint64_t m_allocs = 0;
+  uint64_t m_alloc_bytes = 0;
+  int64_t m_peak_bytes = 0;  // of live bytes, above those when the test has started
+  double m_counters[perf_counter_count] = {};  // per iteration for benchmarks; NaN if unknown
+  int m_runs = 0;  // in this run_all, with --repeat
+  int m_failed_runs = 0;
+  std::vector<double> m_run_ns;  // wall time of each run, with --repeat
+
+  static bool is_name_disabled(const char* name) {
+    static const char kDisabled[] = "DISABLED";
+    static const size_t nDisabled = strlen(kDisabled);
+    return strncmp(name, kDisabled, nDisabled) == 0;
+  }
+
+  TestCase(const char* suite, const char* name, void(*func)(), bool enabled = true, double timeout_ms = 0)
+    : m_suite(suite)
+    , m_name(name)
+    , m_func(func)
+    , m_enabled(enabled && !is_name_disabled(suite) && !is_name_disabled(name))
+    , m_timeout_ms(timeout_ms)
+    , m_show_green_assertions(show_green_assertions())
+  {
+    link();
+  }
+
+  TestCase(const char* suite, const char* name, void(*func)(), test_preset_func preset,
+      suite_fixture* fixture = nullptr)
+    : m_suite(suite)
+    , m_name(name)
+    , m_func(func)
+    , m_preset(preset)
+    , m_enabled(!is_name_disabled(suite) && !is_name_disabled(name))
+    , m_show_green_assertions(show_green_assertions())
+    , m_suite_fixture(fixture)
+  {
+    link();
+  }
+
+  // an instance of TEST_P, see param_instantiation
+  TestCase(const char* suite, const char* name,
+      param_test_func func, const param_source_base& source, size_t index, bool enabled)
+    : m_suite(suite)
+    , m_name(name)
+    , m_enabled(enabled)
+    , m_param_func(func)
+    , m_param_source(&source)
+    , m_param_index(index)
+    , m_show_green_assertions(show_green_assertions())
+  {
+    link();
+  }
+
+  TestCase(const char* suite, const char* name, async_test_func async_func, test_preset_func preset)
+    : m_suite(suite)
+    , m_name(name)
+    , m_async_func(async_func)
+    , m_preset(preset)
+    , m_enabled(!is_name_disabled(suite) && !is_name_disabled(name))
+    , m_show_green_assertions(show_green_assertions())
+  {
+    link();
+  }
+
+  TestCase(const char* suite, const char* name, void(*bench_func)(benchmark_state&), bool enabled = true)
+    : m_suite(suite)
+    , m_name(name)
+    , m_bench_func(bench_func)
+    , m_enabled(enabled && !is_name_disabled(suite) && !is_name_disabled(name))
+    , m_show_green_assertions(show_green_assertions())
+  {
+    link();
+  }
+
+  TestCase(const char* suite, const char* name, void(*bench_func)(benchmark_state&), test_preset_func preset)
+    : m_suite(suite)
+    , m_name(name)
+    , m_bench_func(bench_func)
+    , m_preset(preset)
+    , m_enabled(!is_name_disabled(suite) && !is_name_disabled(name))
+    , m_show_green_assertions(show_green_assertions())
+  {
+    link();
+  }
+
+  void link() {
+    if (first()) {
+      last() = last()->m_next = this;
+    } else {
+      last() = first() = this;
+    }
+    count()++;
+  }
+
+  // evaluates the optional arguments of TEST, once
+  void evaluate_preset() {
+    if (!m_preset) return;
+    test_preset preset = m_preset();
+    m_preset = nullptr;
+    m_enabled = m_enabled && preset.enabled;
+    m_timeout_ms = preset.timeout_ms;
+  }
+
+  bool is_enabled() {
+    evaluate_preset();
+    return m_enabled;
+  }
+
+  bool is_benchmark() const { return m_bench_func != nullptr; }
+  bool is_async() const { return m_async_func != nullptr; }
+
+  double timeout_ms(const run_options& options) const {
+    return m_timeout_ms > 0 ? m_timeout_ms : options.timeout_ms;
+  }
+
+  friend std::ostream& operator << (std::ostream& ost, TestCase const& t) {
+    return ost << t.m_suite << "." << t.m_name;
+  }
+
+  // the runner, see simple_test_runner.h
+  void run_benchmark(const run_options& options);
+  void fail(const std::string& reason);
+  template<class F> void guarded(const char* part, F&& func);
+  void set_up_suite();
+  // runs the test in the current thread and prints its verdict
+  void run(const run_options& options = {});
+  bool is_slow(const run_options& options) const;
+  void print_verdict(const run_options& options) const;
+  void finish_output(const run_options& options) const;
+  void record_run(const run_options& options);
+  static void run_isolated(const std::vector<TestCase*>& tests, const run_options& options);
+  static void run_async(const std::vector<TestCase*>& tests, const run_options& options);
+  void run_async_body();
+  template<class Filter> static bool run_all(Filter name_filter, const run_options& options = {});
+  static bool print_summary(
+      const std::vector<TestCase*>& tests, const std::atomic<bool>* finished, const TestCase* timed_out,
+      int num_skipped, int num_cached, const run_options& options, double total_ns);
+  static void print_timing(const std::vector<TestCase*>& tests, const run_options& options, double total_ns);
+  static void print_repeats(const std::vector<TestCase*>& tests, int iterations, const run_options& options);
+  std::vector<double> timing_samples() const;
+  static bool compare_baseline(const std::vector<TestCase*>& tests, const run_options& options);
+};
+
+// value-parameterized tests
+
+// A parameter generator is a lazy random-access sequence: size() and operator[](index).
+// Its values are produced when the instance of the test runs, not when it is registered.
+
+// begin, begin + step, ... (up to end, exclusive)
+template<class T> struct range_generator {
+  T begin, end, step;
+  size_t size() const {
+    if (!(begin < end)) return 0;
+    if constexpr (std::is_integral_v<T>) {
+      return static_cast<size_t>((end - begin - 1) / step) + 1;
+    } else {
+      return static_cast<size_t>(std::ceil((end - begin) / step));
+    }
+  }
+  T operator[](size_t i) const { return static_cast<T>(begin + static_cast<T>(i) * step); }
+};
+template<class T> range_generator<T> range(T begin, T end, T step = 1) { return {begin, end, step}; }
+
+template<class T, size_t N> struct values_generator {
+  T items[N];
+  size_t size() const { return N; }
+  const T& operator[](size_t i) const { return items[i]; }
+};
+template<class... Ts> auto values(const Ts&... xs) {
+  using T = std::common_type_t<std::decay_t<const Ts&>...>;
+  return values_generator<T, sizeof...(Ts)>{{static_cast<T>(xs)...}};
+}
+
+// a copy of a container (which is materialized already)
+template<class Container> auto values_in(const Container& xs) {
+  struct generator {
+    std::vector<std::decay_t<decltype(*std::begin(std::declval<const Container&>()))>> items;
+    size_t size() const { return items.size(); }
+    const auto& operator[](size_t i) const { return items[i]; }
+  };
+  return generator{{std::begin(xs), std::end(xs)}};
+}
+
+// cartesian product of generators, as tuples; the last one runs fastest
+template<class... Gs> struct combine_generator {
+  std::tuple<Gs...> gens;
+  size_t size() const {
+    return std::apply([](const auto&... g) { return (size_t(1) * ... * g.size()); }, gens);
+  }
+  auto operator[](size_t i) const { return at(i, std::index_sequence_for<Gs...>{}); }
+
+private:
+  template<size_t... K> auto at(size_t i, std::index_sequence<K...>) const {
+    size_t sizes[] = {std::get<K>(gens).size()...};
+    size_t digits[sizeof...(K)];
+    for (size_t k = sizeof...(K); k--; ) {
+      digits[k] = i % sizes[k];
+      i /= sizes[k];
+    }
+    return std::make_tuple(std::get<K>(gens)[digits[K]]...);
+  }
+};
+template<class... Gs> combine_generator<Gs...> combine(Gs... gens) {
+  return {std::tuple<Gs...>(std::move(gens)...)};
+}
+
+// lines of a text file, streamed: only offsets of the lines are kept,
+// and each line is read when its test runs (threads may read at once)
+struct lines_of {
+  struct file {
+    int fd = -1;
+    std::vector<off_t> offsets;  // of each line, and the end of the file
+    ~file() { if (fd >= 0) close(fd); }
+  };
+  std::shared_ptr<file> m_file = std::make_shared<file>();
+
+  explicit lines_of(const char* path) {
+    m_file->fd = open(path, O_RDONLY);
+    if (m_file->fd < 0) throw std::runtime_error(std::string("can't open ") + path + ": " + strerror(errno));
+    char buf[65536];
+    off_t offset = 0;
+    m_file->offsets.push_back(0);
+    for (ssize_t n; (n = read(m_file->fd, buf, sizeof(buf))) != 0; ) {
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error(std::string("can't read ") + path + ": " + strerror(errno));
+      }
+      for (const char* p = buf; (p = static_cast<const char*>(memchr(p, '\n', buf + n - p))); ++p) {
+        m_file->offsets.push_back(offset + (p - buf) + 1);
+      }
+      offset += n;
+    }
+    if (m_file->offsets.back() != offset) m_file->offsets.push_back(offset);  // no trailing newline
+  }
+
+  size_t size() const { return m_file->offsets.size() - 1; }
+  std::string operator[](size_t i) const {
+    std::string line(m_file->offsets[i + 1] - m_file->offsets[i], '\0');
+    for (size_t done = 0; done != line.size(); ) {
+      ssize_t n = pread(m_file->fd, line.data() + done, line.size() - done, m_file->offsets[i] + done);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) throw std::runtime_error("can't read line " + std::to_string(i + 1));
+      done += n;
+    }
+    if (!line.empty() && line.back() == '\n') line.pop_back();
+    return line;
+  }
+};
+
+// type-erased generator of INSTANTIATE_TEST_SUITE_P
+struct param_source_base {
+  virtual ~param_source_base() = default;
+  virtual size_t size() const = 0;
+};
+template<class T> struct param_source : param_source_base {
+  virtual T get(size_t i) const = 0;
+};
+template<class T, class G> struct param_source_of : param_source<T> {
+  G gen;
+  explicit param_source_of(G g) : gen(std::move(g)) {}
+  size_t size() const override { return gen.size(); }
+  T get(size_t i) const override { return static_cast<T>(gen[i]); }
+};
+template<class T, class G> param_source_of<T, G> make_param_source(G gen) {
+  return param_source_of<T, G>(std::move(gen));
+}
+
+// GTest-like base of a fixture
+struct Test {
+  virtual ~Test() = default;
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+  // hide them in the fixture to share expensive state between the tests of the suite
+  static void SetUpTestSuite() {}
+  static void TearDownTestSuite() {}
+};
+
+// a suite of TEST_P shall be a class derived from TestWithParam<T>
+template<class T> struct TestWithParam : Test {
+  using ParamType = T;
+  const T* m_param = nullptr;
+  const T& GetParam() const { return *m_param; }
+};
+
+// TearDown runs even if the body fails
+// (the test class forwards them, as they may be protected in the fixture)
+template<class Fixture> void run_fixture(Fixture& fixture) {
+  fixture.set_up();
+  try {
+    fixture.body();
+  } catch (...) {
+    fixture.tear_down();
+    throw;
+  }
+  fixture.tear_down();
+}
+
+template<class Fixture> void run_fixture_test() {
+  Fixture fixture;
+  run_fixture(fixture);
+}
+
+template<class Suite, class Fixture> void run_param_test(const param_source_base& source, size_t index) {
+  using T = typename Suite::ParamType;
+  const T param = static_cast<const param_source<T>&>(source).get(index);
+  Fixture fixture;
+  fixture.m_param = &param;
+  run_fixture(fixture);
+}
+
+// SetUpTestSuite and TearDownTestSuite of a fixture of TEST_F:
+// the suite is set up by the first of its selected tests which starts
+// (the others wait for it, if they run in parallel), and is torn down
+// by the last one which finishes; the runner counts them in `pending`.
+struct suite_fixture {
+  void (*set_up)();
+  void (*tear_down)();
+  std::mutex mutex;
+  int pending = 0;  // selected tests which have not finished
+  enum { idle, ready, failed } state = idle;
+
+  suite_fixture(void (*set_up_func)(), void (*tear_down_func)())
+    : set_up(set_up_func), tear_down(tear_down_func) {}
+
+  // one for all the tests of the fixture
+  template<class Fixture> static suite_fixture* of(void (*set_up_func)(), void (*tear_down_func)()) {
+    static suite_fixture fixture{set_up_func, tear_down_func};
+    return &fixture;
+  }
+
+  // before each test; false if the set-up has failed in another test
+  bool enter() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (state == idle) {
+      state = failed;  // unless it returns
+      set_up();
+      state = ready;
+      return true;
+    }
+    return state == ready;
+  }
+
+  // after each test, even a failed one
+  void leave() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--pending > 0) return;
+    pending = 0;
+    const bool was_set_up = state == ready;
+    state = idle;  // a next run sets it up again
+    if (was_set_up) tear_down();
+  }
+};
+
+// TEST_P: a pattern of a test, registered into its own chain
+struct param_test {
+  static param_test*& first() { static param_test* t = nullptr; return t; }
+  static param_test*& last() { static param_test* t = nullptr; return t; }
+
+  param_test* m_next = nullptr;
+  const char* m_suite;
+  const char* m_name;
+  param_test_func m_func;
+
+  param_test(const char* suite, const char* name, param_test_func func)
+    : m_suite(suite), m_name(name), m_func(func) {
+    last() = (first() ? last()->m_next : first()) = this;
+  }
+};
+
+// INSTANTIATE_TEST_SUITE_P: the generator is made and instances of the suite's TEST_P
+// are registered as "prefix/suite.name/index" only when the tests are listed or run
+// (see expand(); it allocates a block for all the instances and their names, not one per instance)
+struct param_instantiation {
+  using source_func = const param_source_base& (*)();
+
+  static param_instantiation*& first() { static param_instantiation* t = nullptr; return t; }
+  static param_instantiation*& last() { static param_instantiation* t = nullptr; return t; }
+
+  param_instantiation* m_next = nullptr;
+  const char* m_prefix;
+  const char* m_suite;
+  source_func m_source;
+
+  bool m_expanded = false;
+  std::string m_error;  // the generator has failed, an instance reports it
+  std::unique_ptr<char[]> m_names;
+  std::vector<TestCase> m_tests;
+
+  param_instantiation(const char* prefix, const char* suite, source_func source)
+    : m_prefix(prefix), m_suite(suite), m_source(source) {
+    last() = (first() ? last()->m_next : first()) = this;
+  }
+
+  // the runner, see simple_test_runner.h
+  void expand();
+  static void expand_all();
+};
+
+// the last failure reported by this thread
+struct thread_failure {
+  TestCase* test = nullptr;  // none if the thread belongs to no test
+  size_t index = 0;  // in m_failures of the test
+  size_t mark = 0;  // where the report starts in the output of the thread
+};
+
+inline thread_failure& this_thread_failure() {
+  thread_local thread_failure f;
+  return f;
+}
+
+// the output of a thread which is not started by simple_test goes to its test when the thread exits
+struct foreign_thread_output {
+  TestCase* owner = nullptr;
+  ~foreign_thread_output() {
+    std::string& text = simple_print::thread_output::instance().buf.text;  // constructed before this
+    std::lock_guard<std::mutex> lock(TestCase::failures_mutex());
+    if (text.empty() || TestCase::sole_running() != owner) return;
+    owner->m_thread_output += text;
+    text.clear();
+  }
+};
+
+// the report of a failure (after its location) starts in the output here...
+SIMPLE_TEST_COLD inline void begin_failure(const char* file, int line) {
+  thread_failure& f = this_thread_failure();
+  f.test = TestCase::owner_of_this_thread();
+  if (!f.test) {
+    TestCase::unowned_failures()++;
+    simple_print::colored_cout_line(simple_print::red)
+        << "  in a thread of an unknown test: start it with simple_test::test_thread when tests run in parallel";
+  }
+  f.mark = simple_print::thread_output::instance().buf.text.size();
+  if (!f.test) return;
+  std::lock_guard<std::mutex> lock(TestCase::failures_mutex());
+  f.index = f.test->m_failures.size();
+  f.test->m_failures.push_back({file, line, {}});
+}
+
+// ...and ends here (with the user's message), so it is copied to the failure;
+// an assertion stops the test, or the thread of the test (see test_thread),
+// but it can't stop a thread which is not started by simple_test, so it goes on there
+SIMPLE_TEST_COLD inline void test_failed(bool assertion) {
+  TestCase* t = TestCase::owner_of_this_thread();
+  if (t) {
+    const thread_failure& f = this_thread_failure();
+    std::string message;
+    if (f.test == t) {
+      const std::string& text = simple_print::thread_output::instance().buf.text;
+      for (size_t i = f.mark; i < text.size(); ++i) {
+        if (text[i] == '\033') {  // skip colors: ESC [ ... m
+          while (i < text.size() && text[i] != 'm') ++i;
+        } else {
+          message += text[i];
+        }
+      }
+      while (!message.empty() && isspace(static_cast<unsigned char>(message.back()))) message.pop_back();
+    }
+    std::lock_guard<std::mutex> lock(TestCase::failures_mutex());
+    t->m_passed = false;
+    if (f.test == t && f.index < t->m_failures.size() && t->m_failures[f.index].message.empty()) {
+      t->m_failures[f.index].message = std::move(message);
+    }
+  }
+  if (t && !TestCase::current()) {
+    thread_local foreign_thread_output output;
+    output.owner = t;
+  }
+  if (assertion && TestCase::current()) throw assertion_fault{};
+}
+
+struct examination_afterword {
+  bool passed;
+  bool assertion;
+  void operator <<= (auto&&) && {
+    if (!passed) test_failed(assertion);
+  }
+};
+
+inline constexpr auto get_color(bool passed, bool assertion) {
+  return passed ? simple_print::green : assertion ? simple_print::red : simple_print::yellow;
+}
+
+// testing functions
+
+// after a failed ==: where the values differ, if they are strings or containers (see below)
+SIMPLE_TEST_COLD void print_difference(const char* color, const auto& a, const auto& b);
+
+SIMPLE_TEST_COLD void report_comparison(
+    const char* file, int line,
+    const char* aexpr, const auto& a,
+    const char* bexpr, const auto& b,
+    bool passed, bool assertion, const char* opexpr) {
+  auto color = get_color(passed, assertion);
+  const char* category = assertion ? "assertion" : "expectation";
+  const char* verdict = passed ? "passed" : "failed";
+  simple_print::colored_cout_line(color) << file << ":" << line;
+  if (!passed) begin_failure(file, line);
+  simple_print::colored_cout_line(color) << "  " << category << " " << verdict
+      << ": " << aexpr << " " << opexpr << " " << bexpr;
+  simple_print::colored_cout_line(color) << "    left : " << simple_print::verbose(a);
+  simple_print::colored_cout_line(color) << "    right: " << simple_print::verbose(b);
+  if (!passed && std::string_view(opexpr).ends_with("==")) print_difference(color, a, b);
+}
+
+// inlined, so the caller's check of the result and of show_green_assertions() folds into this one
+SIMPLE_TEST_ALWAYS_INLINE bool expect_comparison(
+    const char* file, int line,
+    const char* aexpr, const auto& a,
+    const char* bexpr, const auto& b,
+    bool assertion,  // assert or expect?
+    auto opfunc, const char* opexpr) {
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Waddress"  // EXPECT_TRUE("literal") is a valid check
+#endif
+  bool passed = opfunc(a, b);
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic pop
+#endif
+  if (passed && !show_green_assertions()) [[likely]] return true;
+
+  report_comparison(file, line, aexpr, a, bexpr, b, passed, assertion, opexpr);
+  return passed;
+}
+
+SIMPLE_TEST_COLD inline bool examine_fault(const char* file, int line, bool assertion) {
+  auto color = get_color(false, assertion);
+  simple_print::colored_cout_line(color) << file << ":" << line;
+  begin_failure(file, line);
+  simple_print::colored_cout_line(color) << "  explicitly failed";
+  return false;
+}
+
+// threads of a test
+
+// runs func in this thread as a part of the test: the assertions are reported to it,
+// an assertion (or an exception) stops the thread only, and the output is added to the output of the test
+SIMPLE_TEST_COLD inline void thread_raised(const char* what) {
+  auto color = get_color(false, false);
+  begin_failure("", 0);
+  simple_print::colored_cout_line(color) << "  a thread of the test raised " << what;
+  test_failed(false);
+}
+
+template<class F> void run_in_test(TestCase* owner, F& func) {
+  TestCase::current() = owner;
+  const bool green = show_green_assertions(owner && owner->m_show_green_assertions);
+  try {
+    func();
+  } catch (const assertion_fault&) {
+  } catch (const std::exception& e) {
+    thread_raised(e.what());
+  } catch (...) {
+    thread_raised("an exception");
+  }
+  show_green_assertions(green);
+  TestCase::current() = nullptr;
+  std::string& text = simple_print::thread_output::instance().buf.text;
+  if (owner && !text.empty()) {
+    std::lock_guard<std::mutex> lock(TestCase::failures_mutex());
+    owner->m_thread_output += text;
+    text.clear();
+  }
+}
+
+// the output of the threads of the test which have finished, to the output of the test
+inline void take_thread_output(TestCase* owner) {
+  if (!owner || TestCase::current() != owner) return;
+  std::lock_guard<std::mutex> lock(TestCase::failures_mutex());
+  OUTPUT_STREAM() << owner->m_thread_output;
+  owner->m_thread_output.clear();
+}
+
+// a thread which runs a part of the current test; joined when destroyed
+// (made with pthreads, as <thread> would slow down the compilation of the test files)
+struct test_thread {
+  TestCase* m_owner = nullptr;
+  pthread_t m_thread{};
+  bool m_joinable = false;
+
+  template<class F> explicit test_thread(F func) : m_owner(TestCase::owner_of_this_thread()) {
+    struct start {
+      TestCase* owner;
+      F func;
+    };
+    auto arg = new start{m_owner, std::move(func)};
+    m_joinable = pthread_create(&m_thread, nullptr, [](void* arg) -> void* {
+      std::unique_ptr<start> s(static_cast<start*>(arg));
+      run_in_test(s->owner, s->func);
+      return nullptr;
+    }, arg) == 0;
+    if (!m_joinable) {
+      delete arg;
+      throw std::runtime_error("can't start a thread of the test");
+    }
+  }
+  test_thread(test_thread&& other) noexcept { *this = std::move(other); }
+  test_thread& operator = (test_thread&& other) noexcept {
+    if (this == &other) return *this;
+    join();
+    m_owner = other.m_owner;
+    m_thread = other.m_thread;
+    m_joinable = std::exchange(other.m_joinable, false);
+    return *this;
+  }
+  ~test_thread() { join(); }
+
+  void join() {
+    if (!m_joinable) return;
+    m_joinable = false;
+    pthread_join(m_thread, nullptr);
+    take_thread_output(m_owner);
+  }
+};
+
+// STRESS(threads, iterations) { body };
+// the threads start at once, and each runs the body (with thread_index and iteration) so many times;
+// an assertion or an exception in one of them stops all of them
+struct stress {
+  size_t threads;
+  size_t iterations;
+  const char* file;
+  int line;
+
+  template<class F> void operator <<= (F body) && {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> stopped_by{SIZE_MAX};
+    size_t stopped_at = 0;  // iteration, written by the thread which stopped the others
+    {
+      std::vector<test_thread> workers;
+      workers.reserve(threads);
+      for (size_t t = 0; t != threads; ++t) {
+        workers.emplace_back([&, t] {
+          ready.fetch_add(1);
+          while (ready.load() != threads) sched_yield();  // a barrier, so they run together
+          size_t i = 0;
+          try {
+            for ( ; i != iterations && !stop.load(std::memory_order_relaxed); ++i) body(t, i);
+          } catch (...) {
+            size_t none = SIZE_MAX;
+            if (stopped_by.compare_exchange_strong(none, t)) stopped_at = i;
+            stop = true;
+            throw;
+          }
+        });
+      }
+    }
+    if (stopped_by != SIZE_MAX) {
+      simple_print::colored_cout_line(simple_print::red) << file << ":" << line;
+      simple_print::colored_cout_line(simple_print::red) << "  stress test of " << threads << " threads x "
+          << iterations << " iterations is stopped: thread " << stopped_by << " failed at iteration " << stopped_at;
+    }
+  }
+};
+
+// asynchronous tests
+
+// a coroutine of ASYNC_TEST, or one which it co_awaits; it starts when it is awaited
+// (or, for the body of the test, when the runner starts it), and an exception goes to the awaiting one
+struct task_promise_base {
+  std::coroutine_handle<> continuation;  // none for the body of the test
+  std::exception_ptr exception;
+
+  struct final_awaiter {
+    bool await_ready() const noexcept { return false; }
+    template<class P> std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept {
+      if (std::coroutine_handle<> c = h.promise().continuation) return c;
+      return std::noop_coroutine();  // back to the loop, which sees that the test is done
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  final_awaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template<class T> struct task_promise : task_promise_base {
+  std::optional<T> value;
+  void return_value(T v) { value.emplace(std::move(v)); }
+  T result() { return std::move(*value); }
+};
+
+template<> struct task_promise<void> : task_promise_base {
+  void return_void() const noexcept {}
+  void result() const noexcept {}
+};
+
+template<class T> struct [[nodiscard]] task {
+  struct promise_type : task_promise<T> {
+    task get_return_object() { return task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+  };
+
+  std::coroutine_handle<promise_type> m_handle;
+
+  explicit task(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+  task(task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+  task& operator = (task other) noexcept {
+    std::swap(m_handle, other.m_handle);
+    return *this;
+  }
+  ~task() {
+    if (m_handle) m_handle.destroy();
+  }
+
+  bool done() const { return m_handle.done(); }
+
+  bool await_ready() const noexcept { return false; }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    m_handle.promise().continuation = awaiting;
+    return m_handle;
+  }
+  T await_resume() {
+    if (m_handle.promise().exception) std::rethrow_exception(m_handle.promise().exception);
+    return m_handle.promise().result();
+  }
+};
+
+// what a suspended coroutine waits for, see async_loop
+struct async_waiter {
+  std::coroutine_handle<> handle;
+  void* context = nullptr;  // the test which the coroutine belongs to, set by the loop
+  int fd = -1;  // waited for
+  bool (*is_ready)(async_waiter&) = nullptr;  // checked on each round of the loop
+  uint32_t events = 0;  // of the file descriptor, as epoll reports them
+};
+
+// the event loop which interleaves ASYNC_TESTs on this thread (see epoll_loop in simple_test_runner.h);
+// it resumes the waiting coroutine as the part of its test
+struct async_loop {
+  using clock = std::chrono::steady_clock;
+
+  virtual void at(clock::time_point deadline, async_waiter& w) = 0;
+  virtual void on_fd(int fd, uint32_t events, async_waiter& w) = 0;  // EPOLLIN, EPOLLOUT
+  virtual void poll(async_waiter& w) = 0;  // until w.is_ready(w)
+
+  static async_loop*& current() {
+    thread_local async_loop* loop = nullptr;
+    return loop;
+  }
+  static async_loop& of_this_thread() {
+    if (!current()) throw std::logic_error("co_await outside of ASYNC_TEST");
+    return *current();
+  }
+
+protected:
+  ~async_loop() = default;
+};
+
+struct sleep_awaiter : async_waiter {
+  async_loop::clock::time_point deadline;
+
+  bool await_ready() const noexcept { return false; }  // even a zero sleep lets the other tests run
+  void await_suspend(std::coroutine_handle<> h) {
+    handle = h;
+    async_loop::of_this_thread().at(deadline, *this);
+  }
+  void await_resume() const noexcept {}
+};
+
+struct fd_awaiter : async_waiter {
+  uint32_t wanted;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h) {
+    handle = h;
+    async_loop::of_this_thread().on_fd(fd, wanted, *this);
+  }
+  uint32_t await_resume() const noexcept { return events; }  // may have EPOLLERR, EPOLLHUP
+};
+
+// std::future or std::shared_future (or alike), which is polled on each round of the loop
+template<class Future> struct future_awaiter : async_waiter {
+  Future& future;
+
+  explicit future_awaiter(Future& f) : future(f) {}
+
+  static bool has_value(Future& f) {
+    using status = decltype(f.wait_for(std::chrono::seconds(0)));  // std::future_status, without <future>
+    return f.wait_for(std::chrono::seconds(0)) == status::ready;
+  }
+  bool await_ready() const { return has_value(future); }
+  void await_suspend(std::coroutine_handle<> h) {
+    handle = h;
+    is_ready = [](async_waiter& w) { return has_value(static_cast<future_awaiter&>(w).future); };
+    async_loop::of_this_thread().poll(*this);
+  }
+  decltype(auto) await_resume() { return future.get(); }
+};
+
+inline sleep_awaiter sleep_until(async_loop::clock::time_point deadline) {
+  sleep_awaiter a;
+  a.deadline = deadline;
+  return a;
+}
+inline sleep_awaiter sleep_for(std::chrono::nanoseconds duration) {
+  return sleep_until(async_loop::clock::now() + duration);
+}
+inline fd_awaiter readable(int fd) {
+  fd_awaiter a;
+  a.fd = fd;
+  a.wanted = EPOLLIN;
+  return a;
+}
+inline fd_awaiter writable(int fd) {
+  fd_awaiter a;
+  a.fd = fd;
+  a.wanted = EPOLLOUT;
+  return a;
+}
+template<class Future> future_awaiter<Future> when_ready(Future& future) {
+  return future_awaiter<Future>(future);
+}
+
+// property-based testing
+
+struct property_options {
+  uint64_t seed = 0;  // base seed of the run (testing_main picks one if not set)
+  size_t cases = 100;  // number of random cases of each property
+  int jobs = 1;  // threads to check the cases on
+  size_t max_size = 100;  // the size of generated values grows up to it with the case number
+  size_t max_shrinks = 1000;  // attempts to shrink a counterexample
+  // set by the runner: calls func(context, i) for each i in [0, count) on jobs threads
+  void (*parallel_for)(size_t count, int jobs, void (*func)(void* context, size_t i), void* context) = nullptr;
+};
+
+inline property_options& property_settings() {
+  static property_options options;
+  return options;
+}
+
+// splitmix64: tiny and fast, and each case may start its own sequence
+struct property_rng {
+  uint64_t state;
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+  uint64_t below(uint64_t n) { return n ? next() % n : 0; }
+  double uniform() { return (next() >> 11) * 0x1.0p-53; }  // [0, 1)
+  bool one_in(uint64_t n) { return below(n) == 0; }
+};
+
+// How to generate and to shrink values of a type; specialize it for your types:
+//   static T generate(property_rng& rng, size_t size);
+//   static std::vector<T> shrink(const T& value);  // simpler candidates, the simplest first
+template<class T, class = void> struct arbitrary;
+
+template<> struct arbitrary<bool> {
+  static bool generate(property_rng& rng, size_t) { return rng.next() & 1; }
+  static std::vector<bool> shrink(bool x) { return x ? std::vector<bool>{false} : std::vector<bool>{}; }
+};
+
+template<> struct arbitrary<char> {
+  static char generate(property_rng& rng, size_t) {
+    if (rng.one_in(10)) return static_cast<char>(rng.below(256));
+    return static_cast<char>(' ' + rng.below(95));  // printable
+  }
+  static std::vector<char> shrink(char c) {
+    std::vector<char> xs;
+    for (char simple : {'a', 'b', ' '}) {
+      if (c == simple) break;
+      xs.push_back(simple);
+    }
+    return xs;
+  }
+};
+
+template<class T> struct arbitrary<T, std::enable_if_t<std::is_integral_v<T>>> {
+  static T generate(property_rng& rng, size_t size) {
+    static constexpr T edges[] = {0, 1, static_cast<T>(-1), std::numeric_limits<T>::min(), std::numeric_limits<T>::max()};
+    if (rng.one_in(20)) return edges[rng.below(std::size(edges))];
+    T x = static_cast<T>(rng.below(size + 1));
+    if (std::is_signed_v<T> && (rng.next() & 1)) x = static_cast<T>(-x);
+    return x;
+  }
+  static std::vector<T> shrink(T x) {
+    std::vector<T> xs;
+    if (x == 0) return xs;
+    xs.push_back(0);
+    if constexpr (std::is_signed_v<T>) {
+      if (x < 0 && x != std::numeric_limits<T>::min()) xs.push_back(static_cast<T>(-x));
+    }
+    for (T d = x / 2; d != 0; d /= 2) xs.push_back(static_cast<T>(x - d));  // x/2, 3x/4, ... towards x
+    return xs;
+  }
+};
+
+template<class T> struct arbitrary<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  static T generate(property_rng& rng, size_t size) {
+    static constexpr T edges[] = {0, 1, -1, std::numeric_limits<T>::min(), std::numeric_limits<T>::epsilon()};
+    if (rng.one_in(20)) return edges[rng.below(std::size(edges))];
+    return static_cast<T>((rng.uniform() * 2 - 1) * size);
+  }
+  static std::vector<T> shrink(T x) {
+    std::vector<T> xs;
+    if (x == 0 || !std::isfinite(x)) return xs;
+    xs.push_back(0);
+    if (x < 0) xs.push_back(-x);
+    if (std::trunc(x) != x) xs.push_back(std::trunc(x));
+    if (std::abs(x) > 1) xs.push_back(x / 2);
+    return xs;
+  }
+};
+
+// strings and vectors
+template<class C> struct arbitrary_sequence {
+  using item = typename C::value_type;
+
+  static C generate(property_rng& rng, size_t size) {
+    C xs;
+    for (size_t n = rng.below(size + 1); n; --n) xs.push_back(arbitrary<item>::generate(rng, size));
+    return xs;
+  }
+  static std::vector<C> shrink(const C& xs) {
+    std::vector<C> candidates;
+    if (xs.empty()) return candidates;
+    candidates.push_back(C());
+    const size_t n = xs.size();
+    if (n > 1) {
+      candidates.push_back(C(xs.begin(), xs.begin() + n / 2));
+      candidates.push_back(C(xs.begin() + n / 2, xs.end()));
+    }
+    for (size_t i = 0; i != n && i != 32; ++i) {  // without one item
+      C ys = xs;
+      ys.erase(ys.begin() + i);
+      candidates.push_back(std::move(ys));
+    }
+    for (size_t i = 0; i != n && i != 32; ++i) {  // with a simpler item
+      for (auto&& simpler : arbitrary<item>::shrink(xs[i])) {
+        C ys = xs;
+        ys[i] = std::move(simpler);
+        candidates.push_back(std::move(ys));
+      }
+    }
+    return candidates;
+  }
+};
+template<> struct arbitrary<std::string> : arbitrary_sequence<std::string> {};
+template<class T> struct arbitrary<std::vector<T>> : arbitrary_sequence<std::vector<T>> {};
+
+// runs the body with the arguments, quietly; returns true if it fails
+template<class... Args, class Tuple> bool property_fails(void (*body)(Args...), const Tuple& args) {
+  TestCase* t = TestCase::current();
+  std::string& output = simple_print::thread_output::instance().buf.text;
+  const size_t mark = output.size();
+  const size_t failures = t->m_failures.size();
+  const bool passed = t->m_passed;
+  t->m_passed = true;
+  bool failed;
+  try {
+    Tuple copy = args;  // the body may take its arguments by reference
+    std::apply(body, copy);
+    failed = !t->m_passed;
+  } catch (...) {
+    failed = true;
+  }
+  t->m_passed = passed;
+  t->m_failures.resize(failures);
+  if (output.size() > mark) output.resize(mark);
+  return failed;
+}
+
+inline uint64_t property_seed(uint64_t base, const TestCase& t) {
+  uint64_t h = 14695981039346656037ull;  // FNV-1a of the name
+  for (const char* s : {t.m_suite, ".", t.m_name}) {
+    for ( ; *s; ++s) h = (h ^ static_cast<unsigned char>(*s)) * 1099511628211ull;
+  }
+  return base ^ h;
+}
+
+// Checks the property on random cases; the case i is generated from its own seed,
+// so cases may be checked in any order (and on several threads), and the first failed one is reported.
+// The counterexample is shrunk, printed, and the body runs with it once more, with the output.
+template<class... Args> void check_property(const char* signature, void (*body)(Args...)) {
+  using args_tuple = std::tuple<std::decay_t<Args>...>;
+  const property_options& options = property_settings();
+  TestCase* owner = TestCase::current();
+  const uint64_t seed = property_seed(options.seed, *owner);
+
+  auto make_case = [&](size_t i) {
+    property_rng rng{seed + i * 0x9e3779b97f4a7c15ull};
+    size_t size = 1 + i * options.max_size / std::max<size_t>(options.cases, 1);
+    return args_tuple{arbitrary<std::decay_t<Args>>::generate(rng, size)...};
+  };
+
+  std::atomic<size_t> first_failed{SIZE_MAX};
+  auto check = [&](size_t i) {
+    if (i > first_failed.load(std::memory_order_relaxed)) return;
+    TestCase* current = TestCase::current();
+    TestCase scratch = *owner;  // not registered, just gets the verdict of the case
+    TestCase::current() = &scratch;
+    bool failed = property_fails(body, make_case(i));
+    TestCase::current() = current;
+    if (!failed) return;
+    for (size_t f = first_failed.load(); i < f && !first_failed.compare_exchange_weak(f, i); ) {}
+  };
+  if (options.jobs > 1 && options.parallel_for) {
+    options.parallel_for(options.cases, options.jobs,
+        [](void* context, size_t i) { (*static_cast<decltype(check)*>(context))(i); }, &check);
+  } else {
+    for (size_t i = 0; i != options.cases && first_failed == SIZE_MAX; ++i) check(i);
+  }
+  if (first_failed == SIZE_MAX) return;
+
+  args_tuple best = make_case(first_failed);
+  size_t steps = 0, attempts = 0;
+  auto shrink_one = [&](auto k) {
+    for (auto&& candidate : arbitrary<std::tuple_element_t<k, args_tuple>>::shrink(std::get<k>(best))) {
+      if (++attempts > options.max_shrinks) return false;
+      args_tuple next = best;
+      std::get<k>(next) = std::move(candidate);
+      if (property_fails(body, next)) {
+        best = std::move(next);
+        ++steps;
+        return true;
+      }
+    }
+    return false;
+  };
+  auto shrink_any = [&]<size_t... K>(std::index_sequence<K...>) {
+    return (shrink_one(std::integral_constant<size_t, K>{}) || ...);
+  };
+  while (attempts < options.max_shrinks && shrink_any(std::index_sequence_for<Args...>{})) {}
+
+  simple_print::colored_cout_line(simple_print::red)
+      << *owner << ": property is falsified by case " << first_failed << " of " << options.cases
+      << " (--seed=" << options.seed << "), shrunk in " << steps << " steps";
+  {
+    simple_print::colored_cout_line line(simple_print::red);
+    line << "  " << signature << " = (";
+    std::apply([&line](const auto&... xs) {
+      const char* sep = "";
+      ((line << sep, simple_print::verbose_print(line.ost(), xs), sep = ", "), ...);
+    }, best);
+    line << ")";
+  }
+
+  // once more, to see the assertions
+  owner->m_passed = true;
+  std::apply(body, best);
+  if (owner->m_passed) {
+    simple_print::colored_cout_line(simple_print::red) << "  the counterexample passes when run again (flaky?)";
+    owner->m_passed = false;
+    owner->m_failures.push_back({"", 0, "property is falsified, but the counterexample passes when run again"});
+  }
+}
+
+// comparisons
+
+template<std::size_t N> struct compile_time_str {
+    char buf[N] {};
+    constexpr compile_time_str(const char(&b)[N]) {
+        for (std::size_t i = 0; i != N; ++i) buf[i] = b[i];
+    }
+};
+template<std::size_t N> compile_time_str(const char(&)[N]) -> compile_time_str<N>;
+
+template<compile_time_str s> struct str_tag {};
+
+// decorated name because it will be used outside the namespace
+#define STR_TAG(op) ::simple_test::str_tag<#op>
+
+template<class Tag> struct tagged_cmp;
+
+#define TAGGED_CMP(op) tagged_cmp<STR_TAG(op)>
+
+#define DECLARE_TAGGED_CMP(op) \
+template<> struct TAGGED_CMP(op) { \
+  constexpr auto operator()(const auto& a, const auto& b) const { return a op b; } \
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wsign-compare"
+  #if !defined(__clang__) && __GNUC__ >= 12
+    #pragma GCC diagnostic ignored "-Warray-compare"  // arrays are compared as pointers deliberately
+  #endif
+#elif defined(_MSC_VER)
+  #pragma warning(push)
+  #pragma warning(disable: 4388)
+  #pragma warning(disable: 4389)
+#endif
+
+DECLARE_TAGGED_CMP(==)
+DECLARE_TAGGED_CMP(!=)
+DECLARE_TAGGED_CMP(<)
+DECLARE_TAGGED_CMP(>)
+DECLARE_TAGGED_CMP(<=)
+DECLARE_TAGGED_CMP(>=)
+
+#if defined(__GNUC__) || defined(__clang__)
+  #pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+  #pragma warning(pop)
+#endif
+
+// both sides are converted to bool
+struct bool_equal {
+  constexpr bool operator()(bool a, bool b) const { return a == b; }
+};
+
+template<class Tag> struct tagged_strcmp {
+  constexpr auto operator()(const auto& a, const auto& b) const {
+    return tagged_cmp<Tag>()(std::strcmp(a, b), 0);
+  }
+};
+
+#define TAGGED_STRCMP(op) tagged_strcmp<STR_TAG(op)>
+
+// float comparison
+
+template<class FLOAT> struct nearly_float {
+  FLOAT value, epsilon;
+  // this == x means x belongs to the neighourhood
+  constexpr bool operator == (FLOAT x) const { return value-epsilon <= x && x <= value+epsilon; }
+  constexpr bool operator != (FLOAT x) const { return !(*this == x); }
+  // this < x means x is strictly greater than the upper bound
+  constexpr bool operator <  (FLOAT x) const { return value+epsilon < x; }
+  constexpr bool operator >  (FLOAT x) const { return x < value-epsilon; }
+  // this <= x means x is greater-or-equal than the lower bound
+  constexpr bool operator <= (FLOAT x) const { return value-epsilon <= x; }
+  constexpr bool operator >= (FLOAT x) const { return x <= value+epsilon; }
+
+  friend constexpr bool operator == (FLOAT x, const nearly_float& y) { return y == x; }
+  friend constexpr bool operator != (FLOAT x, const nearly_float& y) { return y != x; }
+  friend constexpr bool operator <  (FLOAT x, const nearly_float& y) { return y >  x; }
+  friend constexpr bool operator >  (FLOAT x, const nearly_float& y) { return y <  x; }
+  friend constexpr bool operator <= (FLOAT x, const nearly_float& y) { return y >= x; }
+  friend constexpr bool operator >= (FLOAT x, const nearly_float& y) { return y <= x; }
+
+  friend std::ostream& operator << (std::ostream& ost, const nearly_float& f) {
+    return ost << f.value << " ± " << f.epsilon;
+  }
+};
+
+template<class FLOAT, class EPS> constexpr auto nearly_abs(FLOAT v, EPS eps) {
+  return nearly_float<FLOAT>{v, static_cast<FLOAT>(std::abs(eps))};
+}
+template<class FLOAT, class EPS> constexpr auto nearly_rel(FLOAT v, EPS eps) {
+  return nearly_abs(v, v * eps);
+}
+
+template<class TAG, class EPS> struct tagged_floatcmp_factory {
+  EPS eps;
+  constexpr auto operator()(const auto& a, const auto& b) const {
+    return tagged_cmp<TAG>()(nearly_abs(a, eps), b);
+  }
+};
+
+#define TAGGED_FLOATCMP(op, eps) tagged_floatcmp<decltype(#op ## _op_tag), decltype(eps)>{eps}
+
+// range comparison: EXPECT_RANGE_EQ(a, b), EXPECT_BYTES_EQ(pa, pb, size)
+
+// contiguous ranges of the same type without padding bits (integers, chars, enums, plain structs of them)
+// are compared as memory, and anything else element by element
+template<class R> concept contiguous_sized_range = requires(const R& r) { std::data(r); std::size(r); };
+
+template<class R> size_t range_size(const R& r) {
+  if constexpr (requires { std::size(r); }) {
+    return std::size(r);
+  } else {
+    return static_cast<size_t>(std::distance(std::begin(r), std::end(r)));
+  }
+}
+
+template<class A, class B> constexpr bool is_memcmp_comparable() {
+  if constexpr (contiguous_sized_range<A> && contiguous_sized_range<B>) {
+    using TA = std::remove_cvref_t<decltype(*std::data(std::declval<const A&>()))>;
+    using TB = std::remove_cvref_t<decltype(*std::data(std::declval<const B&>()))>;
+    return std::is_same_v<TA, TB> && std::has_unique_object_representations_v<TA>;
+  } else {
+    return false;
+  }
+}
+
+template<class A, class B> bool ranges_equal(const A& a, const B& b) {
+  if constexpr (is_memcmp_comparable<A, B>()) {
+    const size_t n = std::size(a);
+    return n == std::size(b) && (n == 0 || memcmp(std::data(a), std::data(b), n * sizeof(*std::data(a))) == 0);
+  } else {
+    auto ia = std::begin(a), ea = std::end(a);
+    auto ib = std::begin(b), eb = std::end(b);
+    for ( ; ia != ea && ib != eb; ++ia, ++ib) {
+      if (!TAGGED_CMP(==)()(*ia, *ib)) return false;
+    }
+    return ia == ea && ib == eb;
+  }
+}
+
+// where the ranges differ: the first mismatch is the size of the shorter one if it is a prefix of the other
+struct range_mismatch {
+  size_t size_a = 0, size_b = 0;
+  size_t first = 0;
+  size_t count = 0;  // of mismatched elements in the common part
+};
+
+template<class A, class B> range_mismatch find_mismatch(const A& a, const B& b) {
+  range_mismatch m{range_size(a), range_size(b)};
+  const size_t n = std::min(m.size_a, m.size_b);
+  m.first = n;
+  if constexpr (is_memcmp_comparable<A, B>()) {
+    const auto* pa = std::data(a);
+    const auto* pb = std::data(b);
+    for (size_t i = 0; i != n; ++i) {
+      if (memcmp(pa + i, pb + i, sizeof(*pa)) == 0) continue;
+      if (!m.count++) m.first = i;
+    }
+  } else {
+    auto ia = std::begin(a);
+    auto ib = std::begin(b);
+    for (size_t i = 0; i != n; ++i, ++ia, ++ib) {
+      if (TAGGED_CMP(==)()(*ia, *ib)) continue;
+      if (!m.count++) m.first = i;
+    }
+  }
+  return m;
+}
+
+inline constexpr size_t mismatch_window = 4;  // elements shown at each side of the first mismatch
+
+// "[first..last): {x, x, [x], x}" around the mismatch
+SIMPLE_TEST_COLD void print_range_window(std::ostream& ost, const auto& r, size_t size, size_t mismatch) {
+  const size_t from = mismatch > mismatch_window ? mismatch - mismatch_window : 0;
+  const size_t to = std::min(size, mismatch + mismatch_window + 1);
+  ost << "[" << from << ".." << to << "): {" << (from ? "..." : "");
+  auto it = std::begin(r);
+  std::advance(it, from);
+  for (size_t i = from; i != to; ++i, ++it) {
+    if (i != 0) ost << ", ";
+    if (i == mismatch) ost << "[";
+    simple_print::verbose_print(ost, *it);
+    if (i == mismatch) ost << "]";
+  }
+  if (to != size) ost << (to ? ", ..." : "...");
+  ost << "}";
+}
+
+SIMPLE_TEST_COLD void report_range_comparison(
+    const char* file, int line,
+    const char* aexpr, const auto& a,
+    const char* bexpr, const auto& b,
+    bool passed, bool assertion) {
+  auto color = get_color(passed, assertion);
+  const char* category = assertion ? "assertion" : "expectation";
+  const char* verdict = passed ? "passed" : "failed";
+  simple_print::colored_cout_line(color) << file << ":" << line;
+  if (!passed) begin_failure(file, line);
+  simple_print::colored_cout_line(color) << "  " << category << " " << verdict
+      << ": " << aexpr << " [range]== " << bexpr;
+  const range_mismatch m = find_mismatch(a, b);
+  if (m.size_a != m.size_b) {
+    simple_print::colored_cout_line(color) << "    sizes: " << m.size_a << " != " << m.size_b;
+  } else {
+    simple_print::colored_cout_line(color) << "    size : " << m.size_a;
+  }
+  if (passed) return;
+  simple_print::colored_cout_line(color) << "    mismatches: " << m.count << " of " << std::min(m.size_a, m.size_b)
+      << (m.count ? ", the first at [" : ", the shorter one ends at [") << m.first << "]";
+  print_range_window(simple_print::colored_cout_line(color) << "    left : ", a, m.size_a, m.first);
+  print_range_window(simple_print::colored_cout_line(color) << "    right: ", b, m.size_b, m.first);
+}
+
+template<class T> constexpr bool is_string_like = std::is_convertible_v<const T&, std::string_view>;
+
+// lengths (sizes) and the first difference, and the neighbourhood of it if the values are shown partially
+SIMPLE_TEST_COLD void print_difference(const char* color, const auto& a, const auto& b) {
+  using A = std::remove_cvref_t<decltype(a)>;
+  using B = std::remove_cvref_t<decltype(b)>;
+  if constexpr (is_string_like<A> && is_string_like<B>) {
+    const std::string_view sa = a, sb = b;
+    const size_t first = std::mismatch(sa.begin(), sa.end(), sb.begin(), sb.end()).first - sa.begin();
+    if (first == sa.size() && first == sb.size()) return;  // equal text, e.g. compared as pointers
+    simple_print::colored_cout_line(color)
+        << "    lengths: " << sa.size() << " and " << sb.size() << ", the first difference at [" << first << "]";
+    const size_t width = simple_print::max_print_width();
+    if (width == 0 || (sa.size() <= width && sb.size() <= width)) return;
+    simple_print::verbose_print_string_at(
+        simple_print::colored_cout_line(color) << "    left : ", sa.data(), sa.size(), first);
+    simple_print::verbose_print_string_at(
+        simple_print::colored_cout_line(color) << "    right: ", sb.data(), sb.size(), first);
+  } else if constexpr (requires { std::begin(a) != std::end(a); std::begin(b) != std::end(b);
+                                  TAGGED_CMP(==)()(*std::begin(a), *std::begin(b)); }) {
+    const range_mismatch m = find_mismatch(a, b);
+    if (!m.count && m.size_a == m.size_b) return;
+    simple_print::colored_cout_line(color) << "    sizes: " << m.size_a << " and " << m.size_b
+        << ", mismatches: " << m.count << (m.count ? ", the first at [" : ", the shorter one ends at [") << m.first << "]";
+    if (std::max(m.size_a, m.size_b) <= 2 * mismatch_window + 1) return;
+    print_range_window(simple_print::colored_cout_line(color) << "    left : ", a, m.size_a, m.first);
+    print_range_window(simple_print::colored_cout_line(color) << "    right: ", b, m.size_b, m.first);
+  }
+}
+
+SIMPLE_TEST_ALWAYS_INLINE bool expect_range_equal(
+    const char* file, int line,
+    const char* aexpr, const auto& a,
+    const char* bexpr, const auto& b,
+    bool assertion) {
+  bool passed = ranges_equal(a, b);
+  if (passed && !show_green_assertions()) [[likely]] return true;
+
+  report_range_comparison(file, line, aexpr, a, bexpr, b, passed, assertion);
+  return passed;
+}
+
+// "+0x40: 00 01 02 03 ..." around the mismatch, and the marks under the differing bytes
+SIMPLE_TEST_COLD inline void report_bytes_comparison(
+    const char* file, int line,
+    const char* aexpr, const unsigned char* a,
+    const char* bexpr, const unsigned char* b,
+    size_t size, bool passed, bool assertion) {
+  static constexpr char hex_digits[] = "0123456789abcdef";
+  auto color = get_color(passed, assertion);
+  const char* category = assertion ? "assertion" : "expectation";
+  const char* verdict = passed ? "passed" : "failed";
+  simple_print::colored_cout_line(color) << file << ":" << line;
+  if (!passed) begin_failure(file, line);
+  simple_print::colored_cout_line(color) << "  " << category << " " << verdict
+      << ": " << aexpr << " [bytes]== " << bexpr << " (" << size << " bytes)";
+  if (passed) return;
+
+  size_t first = size, count = 0;
+  for (size_t i = 0; i != size; ++i) {
+    if (a[i] == b[i]) continue;
+    if (!count++) first = i;
+  }
+  simple_print::colored_cout_line(color) << "    mismatches: " << count << " bytes, the first at [" << first << "]";
+
+  // the 16-byte row with the first mismatch
+  const size_t from = first / 16 * 16;
+  const size_t to = std::min(size, from + 16);
+  char offset[32];
+  snprintf(offset, sizeof(offset), "+0x%zx:", from);
+  auto row = [&](const char* title, const unsigned char* p) {
+    simple_print::colored_cout_line l(color);
+    l << title << offset;
+    for (size_t i = from; i != to; ++i) l.ost() << ' ' << hex_digits[p[i] >> 4] << hex_digits[p[i] & 15];
+  };
+  row("    left : ", a);
+  row("    right: ", b);
+  simple_print::colored_cout_line l(color);
+  l << "           " << std::string(strlen(offset), ' ');
+  size_t last = to;
+  while (a[last - 1] == b[last - 1]) --last;
+  for (size_t i = from; i != last; ++i) l.ost() << (a[i] != b[i] ? " ^^" : "   ");
+}
+
+SIMPLE_TEST_ALWAYS_INLINE bool expect_bytes_equal(
+    const char* file, int line,
+    const char* aexpr, const void* a,
+    const char* bexpr, const void* b,
+    size_t size, bool assertion) {
+  bool passed = size == 0 || memcmp(a, b, size) == 0;
+  if (passed && !show_green_assertions()) [[likely]] return true;
+
+  report_bytes_comparison(file, line, aexpr, static_cast<const unsigned char*>(a),
+      bexpr, static_cast<const unsigned char*>(b), size, passed, assertion);
+  return passed;
+}
+
+// bulk float comparison: EXPECT_ALL_NEAR(a, b, abs_eps, rel_eps), EXPECT_ALL_NEAR_ULP(a, b, ulps)
+
+// floats mapped to integers in the same order, so the distance between them is in ULPs
+template<class F> using ulp_int = std::conditional_t<sizeof(F) == sizeof(int32_t), int32_t, int64_t>;
+
+template<class F> auto ulp_key(F x) {
+  using I = ulp_int<F>;
+  static_assert(sizeof(F) == sizeof(I), "float or double expected");
+  I i;
+  memcpy(&i, &x, sizeof(i));
+  return i < 0 ? -(i & std::numeric_limits<I>::max()) : i;  // -0.0 and +0.0 are both 0
+}
+
+template<class F> uint64_t ulp_distance(F x, F y) {
+  const auto kx = ulp_key(x), ky = ulp_key(y);
+  return kx < ky ? uint64_t(ky) - uint64_t(kx) : uint64_t(kx) - uint64_t(ky);
+}
+
+// |x - y| <= abs + rel * max(|x|, |y|); so it works for negative and near-zero values, unlike nearly_rel
+template<class F> struct abs_rel_near {
+  F abs, rel;
+  bool operator()(F x, F y) const {
+    const bool equal = x == y;  // infinities
+    const bool close = std::abs(x - y) <= abs + rel * std::max(std::abs(x), std::abs(y));
+    return equal | close;
+  }
+  // the same on SIMD vectors, a mask of lanes
+  static constexpr bool simd = true;
+  template<class V> auto lanes(V x, V y) const {
+    using M = decltype(x == y);
+    const M sign = (M)(-V{});  // bits of -0.0
+    auto vabs = [&](V v) { return (V)((M)v & ~sign); };
+    const V ax = vabs(x), ay = vabs(y);
+    return (x == y) | (vabs(x - y) <= abs + rel * (ax < ay ? ay : ax));
+  }
+  // the error in tolerances (NaN if a value is NaN)
+  double error(F x, F y) const {
+    if (x == y) return 0;
+    const double tolerance = abs + rel * std::max(std::abs(x), std::abs(y));
+    return std::abs(double(x) - double(y)) / tolerance;
+  }
+  double limit() const { return 1; }
+  static constexpr const char* unit = "tolerances";
+};
+
+struct abs_rel_tolerance {
+  double abs, rel;
+  template<class F> abs_rel_near<F> of() const { return {F(abs), F(rel)}; }
+  friend std::ostream& operator << (std::ostream& ost, const abs_rel_tolerance& t) {
+    return ost << "abs " << t.abs << ", rel " << t.rel;
+  }
+};
+
+template<class F> struct ulp_near {
+  uint64_t ulps;
+  bool operator()(F x, F y) const {
+    const bool numbers = (x == x) & (y == y);
+    const bool close = ulp_distance(x, y) <= ulps;
+    return numbers & close;
+  }
+  // 64-bit integer comparisons are emulated with SSE2 and are slower than the scalar code
+#if defined(__SSE4_2__) || defined(__aarch64__)
+  static constexpr bool simd = true;
+#else
+  static constexpr bool simd = sizeof(F) == sizeof(int32_t);
+#endif
+  template<class V> auto lanes(V x, V y) const {
+    using M = decltype(x == y);
+    using U = std::make_unsigned_t<ulp_int<F>>;
+    typedef U UM __attribute__((vector_size(sizeof(V))));
+    constexpr auto max = std::numeric_limits<ulp_int<F>>::max();
+    const M ix = (M)x, iy = (M)y;
+    const M kx = ix < 0 ? -(ix & max) : ix, ky = iy < 0 ? -(iy & max) : iy;  // both sides are evaluated
+    const UM distance = kx < ky ? (UM)ky - (UM)kx : (UM)kx - (UM)ky;
+    return (x == x) & (y == y) & (M)(distance <= U(std::min<uint64_t>(ulps, U(-1))));
+  }
+  double error(F x, F y) const {
+    return x == x && y == y ? double(ulp_distance(x, y)) : std::numeric_limits<double>::quiet_NaN();
+  }
+  double limit() const { return double(ulps); }
+  static constexpr const char* unit = "ulps";
+};
+
+struct ulp_tolerance {
+  uint64_t ulps;
+  template<class F> ulp_near<F> of() const { return {ulps}; }
+  friend std::ostream& operator << (std::ostream& ost, const ulp_tolerance& t) { return ost << t.ulps << " ulps"; }
+};
+
+// GTest's EXPECT_FLOAT_EQ, EXPECT_DOUBLE_EQ: within 4 ULPs
+template<class F> struct ulp_equal {
+  constexpr bool operator()(F a, F b) const { return ulp_near<F>{4}(a, b); }
+};
+
+template<class A, class B> auto float_data(const A& a, const B& b) {
+  static_assert(contiguous_sized_range<A> && contiguous_sized_range<B>, "arrays of floats expected");
+  using F = std::remove_cvref_t<decltype(*std::data(a))>;
+  static_assert(std::is_floating_point_v<F> && std::is_same_v<F, std::remove_cvref_t<decltype(*std::data(b))>>,
+      "arrays of the same floating type expected");
+  return std::make_tuple(std::data(a), std::data(b));
+}
+
+// errors above the limit (a whole number), by powers of 2: (limit, 2 limit], (2 limit, 4 limit], ...
+inline constexpr int error_histogram_size = 24;
+
+SIMPLE_TEST_COLD void report_all_near(
+    const char* file, int line,
+    const char* aexpr, const auto& a,
+    const char* bexpr, const auto& b,
+    const auto& tolerance, size_t num_far, bool passed, bool assertion) {
+  auto color = get_color(passed, assertion);
+  const char* category = assertion ? "assertion" : "expectation";
+  const char* verdict = passed ? "passed" : "failed";
+  simple_print::colored_cout_line(color) << file << ":" << line;
+  if (!passed) begin_failure(file, line);
+  simple_print::colored_cout_line(color) << "  " << category << " " << verdict
+      << ": " << aexpr << " [all near] " << bexpr << " (" << tolerance << ")";
+  const size_t size_a = std::size(a), size_b = std::size(b);
+  if (size_a != size_b) {
+    simple_print::colored_cout_line(color) << "    sizes: " << size_a << " != " << size_b;
+    return;
+  }
+  simple_print::colored_cout_line(color) << "    size : " << size_a;
+
+  const auto [pa, pb] = float_data(a, b);
+  using F = std::remove_cvref_t<decltype(*pa)>;
+  const auto near = tolerance.template of<F>();
+  const double limit = std::max(near.limit(), 1.0);
+  size_t worst = size_a, first_nan = size_a, num_nan = 0;
+  double worst_error = 0;
+  size_t histogram[error_histogram_size + 1] = {};  // and the last one for the greater errors
+  for (size_t i = 0; i != size_a; ++i) {
+    const double error = near.error(pa[i], pb[i]);
+    if (error != error) {
+      if (!num_nan++) first_nan = i;
+      continue;
+    }
+    if (error > worst_error) { worst_error = error; worst = i; }
+    if (near(pa[i], pb[i])) continue;
+    int bucket = 0;
+    for (double bound = 2 * limit; error > bound && bucket != error_histogram_size; bound *= 2) ++bucket;
+    histogram[bucket]++;
+  }
+  if (worst == size_a) worst = first_nan;
+  if (worst == size_a) return;  // all equal
+
+  {
+    simple_print::colored_cout_line summary(color);
+    summary << "    mismatches: " << num_far << " of " << size_a << ", the largest error at [" << worst << "]: ";
+    simple_print::verbose_print(summary.ost(), pa[worst]);
+    summary << " vs ";
+    simple_print::verbose_print(summary.ost(), pb[worst]);
+    summary << ", " << near.error(pa[worst], pb[worst]) << " " << near.unit;
+  }
+  if (passed) return;
+
+  simple_print::colored_cout_line(color) << "    errors, in " << near.unit << ":";
+  double bound = limit;
+  for (int bucket = 0; bucket != error_histogram_size + 1; ++bucket, bound *= 2) {
+    if (!histogram[bucket]) continue;
+    simple_print::colored_cout_line l(color);
+    l << "      ";
+    if (bucket == error_histogram_size) {
+      l << "> " << uint64_t(bound);
+    } else {
+      l << "(" << uint64_t(bound) << ", " << uint64_t(bound * 2) << "]";
+    }
+    l << ": " << histogram[bucket];
+  }
+  if (num_nan) simple_print::colored_cout_line(color) << "      NaN: " << num_nan;
+}
+
+// the number of elements which are not near, on SIMD vectors where the compiler has them
+template<class F> size_t count_far(const F* a, const F* b, size_t n, const auto& near) {
+  size_t far = 0, i = 0;
+#if defined(__GNUC__) || defined(__clang__)
+  if constexpr (std::remove_cvref_t<decltype(near)>::simd) {
+    typedef F V __attribute__((vector_size(16)));
+    using M = decltype(V{} == V{});
+    constexpr size_t width = sizeof(V) / sizeof(F);
+    M counts = {};  // per lane
+    for ( ; i + 2 * width <= n; i += 2 * width) {
+      V x1, y1, x2, y2;
+      memcpy(&x1, a + i, sizeof(V));
+      memcpy(&y1, b + i, sizeof(V));
+      memcpy(&x2, a + i + width, sizeof(V));
+      memcpy(&y2, b + i + width, sizeof(V));
+      counts -= ~near.lanes(x1, y1);  // true is -1
+      counts -= ~near.lanes(x2, y2);
+    }
+    for (size_t k = 0; k != width; ++k) far += counts[k];
+  }
+#endif
+  for ( ; i != n; ++i) far += !near(a[i], b[i]);
+  return far;
+}
+
+SIMPLE_TEST_ALWAYS_INLINE bool expect_all_near(
+    const char* file, int line,
+    const char* aexpr, const auto& a,
+    const char* bexpr, const auto& b,
+    const auto& tolerance, bool assertion) {
+  const auto [pa, pb] = float_data(a, b);
+  using F = std::remove_cvref_t<decltype(*pa)>;
+  const auto near = tolerance.template of<F>();
+  const size_t n = std::size(a);
+  size_t num_far = n == std::size(b) ? 0 : 1;
+  if (!num_far) num_far = count_far(pa, pb, n, near);
+  bool passed = !num_far;
+  if (passed && !show_green_assertions()) [[likely]] return true;
+
+  report_all_near(file, line, aexpr, a, bexpr, b, tolerance, num_far, passed, assertion);
+  return passed;
+}
+
+// the check can't be done: report it as a failure
+SIMPLE_TEST_COLD inline void allocations_not_counted(const char* file, int line, bool assertion) {
+  auto color = get_color(false, assertion);
+  simple_print::colored_cout_line(color) << file << ":" << line;
+  begin_failure(file, line);
+  simple_print::colored_cout_line(color)
+      << "  allocations are not counted: define SIMPLE_TEST_COUNT_ALLOCATIONS where the runner is included";
+  test_failed(assertion);
+}
+
+// EXPECT_MAX_ALLOCS(n) { block }: checks the number of allocations in the block
+struct allocation_scope {
+  uint64_t start = thread_allocations().allocs;
+  bool active = true;
+
+  void check(const char* file, int line, const char* nexpr, uint64_t n, bool assertion) {
+    active = false;
+    if (!allocation_counting()) return allocations_not_counted(file, line, assertion);
+    const uint64_t allocs = thread_allocations().allocs - start;
+    if (!expect_comparison(file, line, "allocations in the block", allocs, nexpr, n,
+            assertion, TAGGED_CMP(<=)(), "<=")) {
+      test_failed(assertion);
+    }
+  }
+};
+
+// blocks allocated in the current test and not freed yet: EXPECT_NO_LEAKS()
+inline int64_t leaked_blocks(const char* file, int line, bool assertion) {
+  if (!allocation_counting()) {
+    allocations_not_counted(file, line, assertion);
+    return 0;
+  }
+  const allocation_counters& now = thread_allocations();
+  const allocation_counters& start = TestCase::current()->m_alloc_start;
+  return static_cast<int64_t>(now.allocs - start.allocs) - static_cast<int64_t>(now.frees - start.frees);
+}
+
+}  // namespace simple_test
+
+// GTest's names of the fixture bases, so fixtures compile with both
+namespace testing {
+using simple_test::Test;
+using simple_test::TestWithParam;
+}  // namespace testing
+
+// optional arguments are evaluated only if the test is selected, see simple_test::test_preset
+#define TEST(suite, name, ...) \
+    void _test__##suite##__##name##__func(); \
+    simple_test::TestCase _test__##suite##__##name##__var( \
+        #suite, #name, \
+        _test__##suite##__##name##__func, \
+        +[]{ return simple_test::test_preset(__VA_ARGS__); }); \
+    void _test__##suite##__##name##__func() /* test body goes here */
+
+// the body is a coroutine (so it has co_await or co_return), which may co_await
+// simple_test::sleep_for, readable(fd), writable(fd), when_ready(future) and other simple_test::task<T>;
+// the runner interleaves ASYNC_TESTs on one thread
+#define ASYNC_TEST(suite, name, ...) \
+    simple_test::task<> _async__##suite##__##name##__func(); \
+    simple_test::TestCase _async__##suite##__##name##__var( \
+        #suite, #name, \
+        _async__##suite##__##name##__func, \
+        +[]{ return simple_test::test_preset(__VA_ARGS__); }); \
+    simple_test::task<> _async__##suite##__##name##__func() /* coroutine body goes here */
+
+// the body gets `simple_test::benchmark_state& state`
+// and shall contain the measured loop `for (auto _ : state) { ... }`
+#define BENCHMARK(suite, name, ...) \
+    void _bench__##suite##__##name##__func(simple_test::benchmark_state&); \
+    simple_test::TestCase _bench__##suite##__##name##__var( \
+        #suite, #name, \
+        _bench__##suite##__##name##__func, \
+        +[]{ return simple_test::test_preset(__VA_ARGS__); }); \
+    void _bench__##suite##__##name##__func( \
+        [[maybe_unused]] simple_test::benchmark_state& state) /* benchmark body goes here */
+
+// args is a parenthesized list of parameters, e.g. (int a, const std::string& s);
+// the body is checked with random arguments, see simple_test::check_property
+#define PROPERTY(suite, name, args, ...) \
+    void _prop__##suite##__##name##__body args; \
+    void _prop__##suite##__##name##__func() { \
+      simple_test::check_property(#args, _prop__##suite##__##name##__body); \
+    } \
+    simple_test::TestCase _prop__##suite##__##name##__var( \
+        #suite, #name, \
+        _prop__##suite##__##name##__func, \
+        +[]{ return simple_test::test_preset(__VA_ARGS__); }); \
+    void _prop__##suite##__##name##__body args /* property body goes here */
+
+// members of a test class derived from the fixture, which may call its protected members
+#define SIMPLE_TEST_FIXTURE_MEMBERS(fixture) \
+    static void set_up_suite() { fixture::SetUpTestSuite(); } \
+    static void tear_down_suite() { fixture::TearDownTestSuite(); } \
+    void set_up() { this->SetUp(); } \
+    void tear_down() { this->TearDown(); } \
+    void body()
+
+// suite is a class derived from simple_test::TestWithParam<T>, the body may call GetParam()
+#define TEST_P(suite, name) \
+    struct _test_p__##suite##__##name : suite { SIMPLE_TEST_FIXTURE_MEMBERS(suite); }; \
+    simple_test::param_test _test_p__##suite##__##name##__var( \
+        #suite, #name, \
+        simple_test::run_param_test<suite, _test_p__##suite##__##name>); \
+    void _test_p__##suite##__##name::body() /* test body goes here */
+
+// fixture is a class derived from simple_test::Test (or testing::Test), it names the suite;
+// optional arguments are those of TEST
+#define TEST_F(fixture, name, ...) \
+    struct _test_f__##fixture##__##name : fixture { SIMPLE_TEST_FIXTURE_MEMBERS(fixture); }; \
+    simple_test::TestCase _test_f__##fixture##__##name##__var( \
+        #fixture, #name, \
+        simple_test::run_fixture_test<_test_f__##fixture##__##name>, \
+        +[]{ return simple_test::test_preset(__VA_ARGS__); }, \
+        simple_test::suite_fixture::of<fixture>( \
+            _test_f__##fixture##__##name::set_up_suite, _test_f__##fixture##__##name::tear_down_suite)); \
+    void _test_f__##fixture##__##name::body() /* test body goes here */
+
+// the generator (range, values, values_in, combine, lines_of) is made on demand
+#define INSTANTIATE_TEST_SUITE_P(prefix, suite, ...) \
+    simple_test::param_instantiation _inst__##prefix##__##suite##__var( \
+        #prefix, #suite, \
+        +[]() -> const simple_test::param_source_base& { \
+          static const auto source = simple_test::make_param_source<suite::ParamType>(__VA_ARGS__); \
+          return source; \
+        })
+
+#define EXAMINATION_SUFFIX(passed, assertion) \
+    simple_test::examination_afterword{passed, assertion} <<= \
+      simple_print::colored_cout_line(simple_test::get_color(passed, assertion)).ost()
+
+#define EXAMINE_IMPL(ae, a, be, b, assertion, ...) \
+    if (const bool passed = \
+        simple_test::expect_comparison(__FILE__, __LINE__, ae, a, be, b, assertion, ##__VA_ARGS__); \
+        passed && !simple_test::show_green_assertions()) [[likely]] ; \
+    else EXAMINATION_SUFFIX(passed, assertion)
+#define EXAMINE(a, b, assertion, ...) \
+    EXAMINE_IMPL(#a, a, #b, b, assertion, ##__VA_ARGS__)
+
+#define EXAMINE_CMP(a, op, b, assertion) \
+    EXAMINE(a, b, assertion, simple_test::TAGGED_CMP(op)(), #op)
+#define ASSERT_CMP(a, op, b) EXAMINE_CMP(a, op, b, true)
+#define EXPECT_CMP(a, op, b) EXAMINE_CMP(a, op, b, false)
+
+#define EXAMINE_STRCMP(a, op, b, assertion) \
+    EXAMINE(a, b, assertion, simple_test::TAGGED_STRCMP(op)(), "[strcmp]" #op)
+#define ASSERT_STRCMP(a, op, b) EXAMINE_STRCMP(a, op, b, true)
+#define EXPECT_STRCMP(a, op, b) EXAMINE_STRCMP(a, op, b, false)
+
+#define EXAMINE_BOOL(a, b, assertion) \
+    EXAMINE(a, b, assertion, simple_test::bool_equal(), "is")
+#define ASSERT_BOOL(a, b) EXAMINE_BOOL(a, b, true)
+#define EXPECT_BOOL(a, b) EXAMINE_BOOL(a, b, false)
+
+#define EXAMINE_FLOATCMP(a, op, b, eps, assertion) \
+    EXAMINE_IMPL(#a, simple_test::nearly_abs(a, eps), #b, b, assertion, simple_test::TAGGED_CMP(op)(), "[near]" #op)
+#define ASSERT_FLOATCMP(a, op, b, eps) EXAMINE_FLOATCMP(a, op, b, eps, true)
+#define EXPECT_FLOATCMP(a, op, b, eps) EXAMINE_FLOATCMP(a, op, b, eps, false)
+
+#define EXAMINE_RANGE_EQ(a, b, assertion) \
+    if (const bool passed = simple_test::expect_range_equal(__FILE__, __LINE__, #a, a, #b, b, assertion); \
+        passed && !simple_test::show_green_assertions()) [[likely]] ; \
+    else EXAMINATION_SUFFIX(passed, assertion)
+#define ASSERT_RANGE_EQ(a, b) EXAMINE_RANGE_EQ(a, b, true)
+#define EXPECT_RANGE_EQ(a, b) EXAMINE_RANGE_EQ(a, b, false)
+
+#define EXAMINE_BYTES_EQ(a, b, size, assertion) \
+    if (const bool passed = simple_test::expect_bytes_equal(__FILE__, __LINE__, #a, a, #b, b, size, assertion); \
+        passed && !simple_test::show_green_assertions()) [[likely]] ; \
+    else EXAMINATION_SUFFIX(passed, assertion)
+#define ASSERT_BYTES_EQ(a, b, size) EXAMINE_BYTES_EQ(a, b, size, true)
+#define EXPECT_BYTES_EQ(a, b, size) EXAMINE_BYTES_EQ(a, b, size, false)
+
+#define EXAMINE_ALL_NEAR(a, b, tolerance, assertion) \
+    if (const bool passed = simple_test::expect_all_near(__FILE__, __LINE__, #a, a, #b, b, tolerance, assertion); \
+        passed && !simple_test::show_green_assertions()) [[likely]] ; \
+    else EXAMINATION_SUFFIX(passed, assertion)
+#define ASSERT_ALL_NEAR(a, b, abs_eps, rel_eps) \
+    EXAMINE_ALL_NEAR(a, b, (simple_test::abs_rel_tolerance{abs_eps, rel_eps}), true)
+#define EXPECT_ALL_NEAR(a, b, abs_eps, rel_eps) \
+    EXAMINE_ALL_NEAR(a, b, (simple_test::abs_rel_tolerance{abs_eps, rel_eps}), false)
+#define ASSERT_ALL_NEAR_ULP(a, b, ulps) EXAMINE_ALL_NEAR(a, b, simple_test::ulp_tolerance{ulps}, true)
+#define EXPECT_ALL_NEAR_ULP(a, b, ulps) EXAMINE_ALL_NEAR(a, b, simple_test::ulp_tolerance{ulps}, false)
+
+#define EXAMINE_FAULT(assertion) \
+    if (simple_test::examine_fault(__FILE__, __LINE__, assertion)) ; \
+    else EXAMINATION_SUFFIX(false, assertion)
+
+// STRESS(threads, iterations) { body };  the body gets thread_index and iteration
+#define STRESS(threads, iterations) \
+    simple_test::stress{static_cast<size_t>(threads), static_cast<size_t>(iterations), __FILE__, __LINE__} <<= \
+      [&]([[maybe_unused]] size_t thread_index, [[maybe_unused]] size_t iteration)
+
+#define ASSERTION_FAULT()   EXAMINE_FAULT(true)
+#define EXPECTATION_FAULT() EXAMINE_FAULT(false)
+
+#define EXAMINE_THROW(statement, exception, assertion) \
+    try { \
+      statement; \
+      EXAMINE_FAULT(assertion) << "no exception was thrown"; \
+    } \
+    catch (const simple_test::assertion_fault&) { throw; } \
+    catch (const exception&) {} \
+    catch (...) { EXAMINE_FAULT(assertion) << "wrong exception was thrown"; } \
+    // end macro
+
+#define EXAMINE_ANY_THROW(statement, assertion) \
+    try { \
+      statement; \
+      EXAMINE_FAULT(assertion) << "no exception was thrown"; \
+    } \
+    catch (const simple_test::assertion_fault&) { throw; } \
+    catch (...) {} \
+    // end macro
+
+// EXPECT_MAX_ALLOCS(n) { block }
+#define EXAMINE_MAX_ALLOCS(n, assertion) \
+    for (simple_test::allocation_scope _allocation_scope; _allocation_scope.active; \
+        _allocation_scope.check(__FILE__, __LINE__, #n, n, assertion))
+
+#define EXAMINE_NO_LEAKS(assertion) \
+    EXAMINE_IMPL("blocks not freed in the test", simple_test::leaked_blocks(__FILE__, __LINE__, assertion), \
+        "0", 0, assertion, simple_test::TAGGED_CMP(==)(), "==")
+
+#define ASSERT_MAX_ALLOCS(n) EXAMINE_MAX_ALLOCS(n, true)
+#define EXPECT_MAX_ALLOCS(n) EXAMINE_MAX_ALLOCS(n, false)
+#define ASSERT_NO_LEAKS() EXAMINE_NO_LEAKS(true)
+#define EXPECT_NO_LEAKS() EXAMINE_NO_LEAKS(false)
+
+#define EXAMINE_NO_THROW(statement, assertion) \
+    try { \
+      statement; \
+    } \
+    catch (const simple_test::assertion_fault&) { throw; } \
+    catch (...) { EXAMINE_FAULT(assertion) << "some exception was thrown"; } \
+    // end macro
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define SIMPLE_TEST_PPCAT1(a, b) a ## b
+#define SIMPLE_TEST_PPCAT(a, b) SIMPLE_TEST_PPCAT1(a, b)
+#define SHOW_GREEN_ASSERTIONS(flag) \
+    [[maybe_unused]] bool SIMPLE_TEST_PPCAT(_green_assertions_, __COUNTER__) = \
+        simple_test::show_green_assertions(flag)
+
+// GTest-like comparisons
+
+#define ASSERT_EQ(a, b) ASSERT_CMP(a, ==, b)
+#define ASSERT_NE(a, b) ASSERT_CMP(a, !=, b)
+#define ASSERT_LT(a, b) ASSERT_CMP(a, <, b)
+#define ASSERT_GT(a, b) ASSERT_CMP(a, >, b)
+#define ASSERT_LE(a, b) ASSERT_CMP(a, <=, b)
+#define ASSERT_GE(a, b) ASSERT_CMP(a, >=, b)
+#define EXPECT_EQ(a, b) EXPECT_CMP(a, ==, b)
+#define EXPECT_NE(a, b) EXPECT_CMP(a, !=, b)
+#define EXPECT_LT(a, b) EXPECT_CMP(a, <, b)
+#define EXPECT_GT(a, b) EXPECT_CMP(a, >, b)
+#define EXPECT_LE(a, b) EXPECT_CMP(a, <=, b)
+#define EXPECT_GE(a, b) EXPECT_CMP(a, >=, b)
+
+#define ASSERT_STREQ(a, b) ASSERT_STRCMP(a, ==, b)
+#define ASSERT_STRNE(a, b) ASSERT_STRCMP(a, !=, b)
+#define EXPECT_STREQ(a, b) EXPECT_STRCMP(a, ==, b)
+#define EXPECT_STRNE(a, b) EXPECT_STRCMP(a, !=, b)
+
+#define ASSERT_TRUE(a)  ASSERT_BOOL(true, a)
+#define ASSERT_FALSE(a) ASSERT_BOOL(false, a)
+#define EXPECT_TRUE(a)  EXPECT_BOOL(true, a)
+#define EXPECT_FALSE(a) EXPECT_BOOL(false, a)
+
+#define ASSERT_NEAR(a, b, eps) ASSERT_FLOATCMP(a, ==, b, eps)
+#define EXPECT_NEAR(a, b, eps) EXPECT_FLOATCMP(a, ==, b, eps)
+
+#define ASSERT_FLOAT_EQ(a, b) EXAMINE(a, b, true, simple_test::ulp_equal<float>(), "[ulp]==")
+#define ASSERT_DOUBLE_EQ(a, b) EXAMINE(a, b, true, simple_test::ulp_equal<double>(), "[ulp]==")
+#define EXPECT_FLOAT_EQ(a, b) EXAMINE(a, b, false, simple_test::ulp_equal<float>(), "[ulp]==")
+#define EXPECT_DOUBLE_EQ(a, b) EXAMINE(a, b, false, simple_test::ulp_equal<double>(), "[ulp]==")
+
+#define FAIL() ASSERTION_FAULT()
+#define ADD_FAILURE() EXPECTATION_FAULT()
+
+#define ASSERT_THROW(statement, exception) EXAMINE_THROW(statement, exception, true)
+#define EXPECT_THROW(statement, exception) EXAMINE_THROW(statement, exception, false)
+
+#define ASSERT_ANY_THROW(statement) EXAMINE_ANY_THROW(statement, true)
+#define EXPECT_ANY_THROW(statement) EXAMINE_ANY_THROW(statement, false)
+
+#define ASSERT_NO_THROW(statement) EXAMINE_NO_THROW(statement, true)
+#define EXPECT_NO_THROW(statement) EXAMINE_NO_THROW(statement, false)
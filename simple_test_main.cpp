@@ -0,0 +1,6 @@
+// The runner and main(), built once.
+// Test files include just simple_test_core.h and are linked with this one.
+
+#include "simple_test_runner.h"
+
+TESTING_MAIN()
@@ -0,0 +1,2998 @@
+#pragma once
+
+// Author: Nikolay Merkin <merkin@mail.ru> <nickolay.merkin@gmail.com>
+// https://github.com/cpp-practice/simple-test
+// https://github.com/nickolaym/simple_test
+
+// The runner: testing_main() and all it needs.
+// Include it in one file, the tests may include just simple_test_core.h
+
+#include "simple_test_core.h"
+
+#include <link.h>
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cctype>
+#include <cerrno>
+#include <ctime>
+#include <cstdlib>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <deque>
+#include <queue>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+namespace simple_print {
+
+// optional writer thread: the test threads just hand over their buffers to it
+struct async_writer {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::string> queue;
+  std::thread thread;
+  bool running = false;
+  bool stopping = false;
+
+  static async_writer& instance() {
+    static async_writer w;
+    return w;
+  }
+
+  void start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    running = true;
+    stopping = false;
+    output_handoff() = [](std::string& text) { return instance().push(text); };
+    thread = std::thread([this] { loop(); });
+  }
+
+  // writes everything queued so far and joins the thread
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!running) return;
+      stopping = true;
+    }
+    cv.notify_one();
+    thread.join();
+    running = false;
+  }
+
+  // returns false if the writer is not running, so the caller shall write by itself
+  bool push(std::string& text) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!running || stopping) return false;
+      queue.push_back(std::move(text));
+    }
+    cv.notify_one();
+    return true;
+  }
+
+  void loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      cv.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) return;  // and stopping
+      std::string text = std::move(queue.front());
+      queue.pop_front();
+      lock.unlock();
+      {
+        std::lock_guard<std::mutex> out_lock(output_mutex());
+        output_sink()(text.data(), text.size());
+      }
+      lock.lock();
+    }
+  }
+
+  // last resort for a crash: write the queue without waiting for the thread
+  void flush_on_crash() {
+    if (!mutex.try_lock()) return;
+    for (const std::string& text : queue) output_sink()(text.data(), text.size());
+    queue.clear();
+    mutex.unlock();
+  }
+};
+
+// on a fatal signal (or termination request) or std::terminate, the collected output is written out,
+// then the previous handler does its job (e.g. sanitizer's report)
+struct crash_flusher {
+  static constexpr int signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM};
+  inline static struct sigaction old_actions[std::size(signals)];
+  inline static std::terminate_handler old_terminate = nullptr;
+  inline static bool installed = false;
+
+  static void flush() {
+    async_writer::instance().flush_on_crash();
+    thread_output::instance().buf.flush_on_crash();
+  }
+
+  static void on_signal(int sig) {
+    flush();
+    for (size_t i = 0; i != std::size(signals); ++i) {
+      if (signals[i] == sig) sigaction(sig, &old_actions[i], nullptr);
+    }
+    raise(sig);
+  }
+
+  static void on_terminate() {
+    flush();
+    if (old_terminate) old_terminate();
+    abort();
+  }
+
+  static void install() {
+    if (installed) return;
+    installed = true;
+    struct sigaction action = {};
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i != std::size(signals); ++i) {
+      sigaction(signals[i], &action, &old_actions[i]);
+    }
+    old_terminate = std::set_terminate(on_terminate);
+  }
+
+  static void uninstall() {
+    if (!installed) return;
+    installed = false;
+    for (size_t i = 0; i != std::size(signals); ++i) {
+      sigaction(signals[i], &old_actions[i], nullptr);
+    }
+    std::set_terminate(old_terminate);
+  }
+};
+
+}  // namespace simple_print
+
+namespace simple_test {
+
+// Calls func(index) for each index of the queues on a pool of threads, one per queue.
+// Each worker takes the indices from the front of its own queue;
+// an idle worker steals from the back of its neighbours' queues.
+inline void parallel_for_queues(std::vector<std::deque<size_t>> assignment, auto func) {
+  struct worker_queue {
+    std::mutex mutex;
+    std::deque<size_t> items;
+  };
+  const int jobs = static_cast<int>(assignment.size());
+  std::vector<worker_queue> queues(jobs);
+  for (int w = 0; w != jobs; ++w) queues[w].items = std::move(assignment[w]);
+
+  auto pop = [](worker_queue& q, bool own, size_t& i) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.items.empty()) return false;
+    if (own) {
+      i = q.items.front();
+      q.items.pop_front();
+    } else {
+      i = q.items.back();
+      q.items.pop_back();
+    }
+    return true;
+  };
+
+  auto work = [&](int self) {
+    for (;;) {
+      size_t i;
+      bool found = pop(queues[self], true, i);
+      for (int k = 1; k < jobs && !found; ++k) {
+        found = pop(queues[(self + k) % jobs], false, i);
+      }
+      if (!found) return;  // nobody adds new items, so all the work is done
+      func(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int w = 1; w < jobs; ++w) threads.emplace_back(work, w);
+  work(0);
+  for (auto& t : threads) t.join();
+}
+
+// Calls func(index) for each index in [0, count) on a pool of jobs threads,
+// each worker owns a contiguous part of the indices.
+inline void parallel_for(size_t count, int jobs, auto func) {
+  std::vector<std::deque<size_t>> parts(jobs);
+  for (int w = 0; w != jobs; ++w) {
+    for (size_t i = count * w / jobs, e = count * (w + 1) / jobs; i != e; ++i) parts[w].push_back(i);
+  }
+  parallel_for_queues(std::move(parts), func);
+}
+
+// isolated run: tests are executed in child processes,
+// which talk to the parent through a pair of pipes.
+// parent -> child: index of the next test to run (or isolated::quit)
+// child -> parent: isolated::message header followed by its payload
+namespace isolated {
+
+static constexpr uint32_t quit = UINT32_MAX;
+
+enum message_kind : uint32_t { output, passed, failed };
+
+struct message {
+  message_kind kind;
+  uint32_t size;  // size of payload: the output text, or the result
+};
+
+// payload of passed / failed: the result, the samples of a benchmark, then the failures (see write_failures)
+struct result {
+  double wall_ns;
+  double cpu_ns;
+  uint64_t allocs;
+  uint64_t alloc_bytes;
+  int64_t peak_bytes;
+  double counters[simple_test::perf_counter_count];
+  uint32_t bench_samples;  // their number
+};
+
+// each failure as: line, sizes of file and message, file, message
+inline std::string write_failures(const std::vector<simple_test::test_failure>& failures) {
+  std::string data;
+  for (const auto& f : failures) {
+    uint32_t header[3] = {static_cast<uint32_t>(f.line),
+        static_cast<uint32_t>(f.file.size()), static_cast<uint32_t>(f.message.size())};
+    data.append(reinterpret_cast<const char*>(header), sizeof(header));
+    data += f.file;
+    data += f.message;
+  }
+  return data;
+}
+
+inline std::vector<simple_test::test_failure> read_failures(std::string_view data) {
+  std::vector<simple_test::test_failure> failures;
+  uint32_t header[3];
+  while (data.size() >= sizeof(header)) {
+    memcpy(header, data.data(), sizeof(header));
+    data.remove_prefix(sizeof(header));
+    if (data.size() < size_t(header[1]) + header[2]) break;
+    failures.push_back({std::string(data.substr(0, header[1])), static_cast<int>(header[0]),
+        std::string(data.substr(header[1], header[2]))});
+    data.remove_prefix(header[1] + header[2]);
+  }
+  return failures;
+}
+
+using simple_print::write_all;
+
+inline bool read_all(int fd, void* data, size_t size) {
+  for (auto p = static_cast<char*>(data); size; ) {
+    ssize_t n = read(fd, p, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+// no allocations here, as it is used as an output sink
+inline bool send(int fd, message_kind kind, const char* data = nullptr, uint32_t size = 0) {
+  message header{kind, size};
+  return write_all(fd, &header, sizeof(header)) && write_all(fd, data, size);
+}
+
+// the child's end of the pipe to the parent
+inline int& parent_fd() {
+  static int fd = -1;
+  return fd;
+}
+
+// the child's output sink: each test's output goes to the parent in one message,
+// and in case of crash the output collected so far goes too
+inline void send_output(const char* data, size_t size) {
+  send(parent_fd(), output, data, static_cast<uint32_t>(size));
+}
+
+// describes how a child process has finished
+inline std::string exit_status(int status) {
+  std::ostringstream ost;
+  if (WIFSIGNALED(status)) {
+    int sig = WTERMSIG(status);
+    ost << "killed by signal " << sig;
+    if (const char* name = strsignal(sig)) ost << " (" << name << ")";
+  } else if (WIFEXITED(status)) {
+    ost << "exited with code " << WEXITSTATUS(status);
+  } else {
+    ost << "terminated with status " << status;
+  }
+  return ost.str();
+}
+
+}  // namespace isolated
+
+struct benchmark_stats {
+  double mean = 0, median = 0, stddev = 0, min = 0;
+
+  explicit benchmark_stats(std::vector<double> samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    min = samples.front();
+    median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    for (double x : samples) mean += x;
+    mean /= n;
+    for (double x : samples) stddev += (x - mean) * (x - mean);
+    stddev = n > 1 ? std::sqrt(stddev / (n - 1)) : 0;
+  }
+};
+
+// One-sided Mann-Whitney U test: the probability that samples b are as much greater than samples a
+// (or more) by chance, if both come from the same distribution.
+// Normal approximation, with the correction for ties and for continuity.
+inline double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b) {
+  const size_t na = a.size(), nb = b.size(), n = na + nb;
+  if (!na || !nb) return 1;
+  std::vector<std::pair<double, bool>> all;  // value, is from b
+  all.reserve(n);
+  for (double x : a) all.push_back({x, false});
+  for (double x : b) all.push_back({x, true});
+  std::sort(all.begin(), all.end());
+  double rank_sum_b = 0, ties = 0;
+  for (size_t i = 0; i != n; ) {
+    size_t j = i;
+    while (j != n && all[j].first == all[i].first) ++j;
+    const double t = static_cast<double>(j - i);
+    const double rank = (i + j + 1) / 2.0;  // ranks are 1-based, the mean of the tied ones
+    for (size_t k = i; k != j; ++k) rank_sum_b += all[k].second ? rank : 0;
+    ties += t * t * t - t;
+    i = j;
+  }
+  const double u = rank_sum_b - nb * (nb + 1) / 2.0;
+  const double mean = na * nb / 2.0;
+  const double variance = na * nb / 12.0 * ((n + 1) - ties / (static_cast<double>(n) * (n - 1)));
+  if (variance <= 0) return 1;
+  const double z = (u - mean - 0.5) / std::sqrt(variance);
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+inline double thread_cpu_ns() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+inline double elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --counters: performance counters of the thread which runs a test, enabled around the test.
+// The events of a thread are opened once, as one group, so they are scheduled together
+// (and scaled, if the kernel multiplexes them). Without a hardware PMU (in containers, VMs)
+// the hardware counters are unavailable; if perf events are not allowed at all,
+// context switches and page faults are taken from getrusage().
+struct perf_counters {
+  enum source : uint8_t { unavailable, perf_event, resource_usage };
+
+  static constexpr const char* names[perf_counter_count] = {
+      "instructions", "cycles", "cache-misses", "branch-misses", "context-switches", "page-faults"};
+  static constexpr uint32_t types[perf_counter_count] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE};
+  static constexpr uint64_t configs[perf_counter_count] = {
+      PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES, PERF_COUNT_SW_PAGE_FAULTS};
+  static constexpr size_t context_switches = 4;
+  static constexpr size_t page_faults = 5;
+
+  // how each counter is read: chosen by probe() before the run, then followed by all threads
+  static std::array<source, perf_counter_count>& sources() {
+    static std::array<source, perf_counter_count> s{};
+    return s;
+  }
+  static bool enabled() {
+    return std::any_of(sources().begin(), sources().end(), [](source s) { return s != unavailable; });
+  }
+
+  pid_t tid = 0;  // the thread the events count (a forked child shall open its own)
+  int leader = -1;
+  int fds[perf_counter_count] = {-1, -1, -1, -1, -1, -1};
+  size_t slots[perf_counter_count] = {};  // in the values of the group
+  size_t members = 0;
+  int error = 0;  // of the first event which failed to open
+  rusage usage_start{};
+
+  perf_counters() = default;
+  perf_counters(const perf_counters&) = delete;
+  ~perf_counters() { close_events(); }
+
+  // of the calling thread
+  static perf_counters& instance() {
+    thread_local perf_counters counters;
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (counters.tid != tid) counters.open(tid);
+    return counters;
+  }
+
+  static int open_event(size_t i, int group) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = types[i];
+    attr.config = configs[i];
+    attr.disabled = group < 0;  // members follow the leader
+    // user space only, as perf_event_paranoid 2 allows (context switches happen in the kernel)
+    attr.exclude_kernel = types[i] == PERF_TYPE_HARDWARE;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+  }
+
+  void close_events() {
+    for (int& fd : fds) {
+      if (fd >= 0 && fd != leader) close(fd);
+      fd = -1;
+    }
+    if (leader >= 0) close(leader);
+    leader = -1;
+    members = 0;
+  }
+
+  void open(pid_t thread) {
+    close_events();
+    tid = thread;
+    error = 0;
+    for (size_t i = 0; i != perf_counter_count; ++i) {
+      if (sources()[i] != perf_event) continue;
+      int fd = open_event(i, leader);
+      if (fd < 0) {
+        if (!error) error = errno;
+        continue;
+      }
+      if (leader < 0) leader = fd;
+      fds[i] = fd;
+      slots[i] = members++;
+    }
+  }
+
+  // chooses the sources of the selected counters; returns a note on the unavailable ones
+  static std::string probe(unsigned selected) {
+    for (size_t i = 0; i != perf_counter_count; ++i) {
+      sources()[i] = selected & (1u << i) ? perf_event : unavailable;
+    }
+    perf_counters& counters = instance();
+    counters.open(counters.tid);
+    std::vector<const char*> missing, from_rusage;
+    for (size_t i = 0; i != perf_counter_count; ++i) {
+      if (sources()[i] != perf_event || counters.fds[i] >= 0) continue;
+      bool by_rusage = i == context_switches || i == page_faults;
+      sources()[i] = by_rusage ? resource_usage : unavailable;
+      (by_rusage ? from_rusage : missing).push_back(names[i]);
+    }
+    auto join = [](const std::vector<const char*>& items) {
+      std::string text;
+      for (const char* item : items) text += (text.empty() ? "" : ", ") + std::string(item);
+      return text;
+    };
+    std::string note;
+    if (!missing.empty()) note += join(missing) + " unavailable";
+    if (!from_rusage.empty()) note += (note.empty() ? "" : "; ") + join(from_rusage) + " from getrusage()";
+    if (!note.empty()) note += std::string(" (perf_event_open: ") + strerror(counters.error) + ")";
+    return note;
+  }
+
+  void start() {
+    if (leader >= 0) {
+      ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    getrusage(RUSAGE_THREAD, &usage_start);
+  }
+
+  void stop(double (&values)[perf_counter_count]) {
+    if (leader >= 0) ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    rusage usage{};
+    getrusage(RUSAGE_THREAD, &usage);
+
+    // nr, time enabled, time running, values
+    uint64_t group[3 + perf_counter_count] = {};
+    const bool read_ok = leader >= 0 && read(leader, group, sizeof(group)) >= ssize_t(3 * sizeof(uint64_t));
+    const double scale = read_ok && group[2] ? double(group[1]) / group[2] : NAN;  // NaN if never scheduled
+    for (size_t i = 0; i != perf_counter_count; ++i) {
+      values[i] = NAN;
+      if (sources()[i] == perf_event && fds[i] >= 0 && read_ok && slots[i] < group[0]) {
+        values[i] = group[3 + slots[i]] * scale;
+      } else if (sources()[i] == resource_usage) {
+        values[i] = i == context_switches
+            ? double(usage.ru_nvcsw + usage.ru_nivcsw - usage_start.ru_nvcsw - usage_start.ru_nivcsw)
+            : double(usage.ru_minflt + usage.ru_majflt - usage_start.ru_minflt - usage_start.ru_majflt);
+      }
+    }
+  }
+};
+
+// measures the time of an iteration of the benchmark body, in ns, several times
+// (and the performance counters per iteration, if they are enabled)
+inline std::vector<double> measure_benchmark(
+    void (*func)(benchmark_state&), benchmark_state& state, const run_options& options,
+    double (&counters)[perf_counter_count]) {
+  const double sample_ns = options.bench_sample_ms * 1e6;
+
+  // find a number of iterations which lasts long enough to be measured
+  state.m_iterations = 1;
+  for (;;) {
+    func(state);
+    double elapsed = state.elapsed_ns();
+    if (elapsed >= sample_ns / 10 || state.m_iterations >= (SIZE_MAX / 100)) {
+      double predicted = state.m_iterations * sample_ns / std::max(elapsed, 1.0);
+      state.m_iterations = std::max<size_t>(1, static_cast<size_t>(predicted));
+      break;
+    }
+    state.m_iterations *= 10;
+  }
+
+  const bool count = perf_counters::enabled();
+  if (count) perf_counters::instance().start();
+  std::vector<double> samples;
+  for (int i = 0; i < options.bench_samples; ++i) {
+    func(state);
+    samples.push_back(state.elapsed_ns() / state.m_iterations);
+  }
+  if (count) {
+    perf_counters::instance().stop(counters);
+    for (double& value : counters) value /= static_cast<double>(state.m_iterations) * samples.size();
+  }
+  return samples;
+}
+
+// 1234.5 -> "1.23 k"
+inline std::string format_si(double value) {
+  static const char* prefixes[] = {"", "k", "M", "G", "T"};
+  size_t i = 0;
+  for ( ; value >= 1000 && i + 1 < std::size(prefixes); ++i) value /= 1000;
+  std::ostringstream ost;
+  ost << std::setprecision(3) << value << " " << prefixes[i];
+  return ost.str();
+}
+
+// 1234.5 ns -> "1.23 us"
+inline std::string format_ns(double ns) {
+  static const char* units[] = {"ns", "us", "ms", "s"};
+  size_t i = 0;
+  for ( ; ns >= 1000 && i + 1 < std::size(units); ++i) ns /= 1000;
+  std::ostringstream ost;
+  ost << std::setprecision(3) << ns << " " << units[i];
+  return ost.str();
+}
+
+// " 1.23 M instructions, 456 k cycles, ..., IPC 2.7" (of the known values)
+inline void print_counters(std::ostream& ost, const double (&values)[perf_counter_count]) {
+  const char* sep = " ";
+  for (size_t i = 0; i != perf_counter_count; ++i) {
+    if (std::isnan(values[i])) continue;
+    std::string value = format_si(values[i]);
+    ost << sep << value << (value.back() == ' ' ? "" : " ") << perf_counters::names[i];
+    sep = ", ";
+  }
+  if (double instructions = values[0], cycles = values[1]; cycles > 0 && !std::isnan(instructions)) {
+    ost << sep << "IPC " << std::setprecision(3) << instructions / cycles;
+  }
+  if (*sep == ' ') ost << " unknown";
+}
+
+// Tests grouped by suite (in order of the first appearance of the suite,
+// then in order of registration), in one contiguous table, with lookup by name.
+// It is built from the chain of TestCase when the tests are about to be listed or run,
+// so the registration before main() costs just a link.
+struct test_registry {
+  struct suite {
+    std::string_view name;
+    size_t begin, end;  // range in tests
+  };
+
+  std::vector<TestCase*> tests;
+  std::vector<suite> suites;
+  std::unordered_map<std::string_view, size_t> suite_index;
+  size_t m_size = 0;  // TestCase::count() the table was built at
+  bool m_built = false;
+
+  // rebuilt if tests have been registered since the last call
+  static const test_registry& instance();
+
+  const suite* find(std::string_view suite_name) const;
+  TestCase* find(std::string_view suite_name, std::string_view test_name) const;
+
+private:
+  void build();
+};
+
+// Watches the tests running in this process and reports the first one exceeding its timeout.
+// The report is expected to never return (e.g. to print the summary and exit).
+struct watchdog {
+  using clock = std::chrono::steady_clock;
+  using report_func = std::function<void(const TestCase& test, double elapsed_ns, double timeout_ns)>;
+
+  struct entry {
+    const TestCase* test;
+    clock::time_point deadline;
+    clock::time_point started;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::map<uint64_t, entry> running;
+  uint64_t next_id = 1;
+  report_func report;
+  std::thread thread;
+  bool active = false;
+  bool stopping = false;
+
+  static watchdog& instance() {
+    static watchdog w;
+    return w;
+  }
+
+  void start(report_func f) {
+    std::lock_guard<std::mutex> lock(mutex);
+    report = std::move(f);
+    active = true;
+    stopping = false;
+    thread = std::thread([this] { loop(); });
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!active) return;
+      stopping = true;
+    }
+    cv.notify_one();
+    thread.join();
+    active = false;
+  }
+
+  // returns an id for end(), or 0 if nobody watches
+  uint64_t begin(const TestCase* test, double timeout_ms) {
+    if (timeout_ms <= 0) return 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!active) return 0;
+    auto now = clock::now();
+    auto deadline = now + std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double, std::milli>(timeout_ms));
+    uint64_t id = next_id++;
+    running[id] = entry{test, deadline, now};
+    cv.notify_one();
+    return id;
+  }
+
+  void end(uint64_t id) {
+    if (!id) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    running.erase(id);
+  }
+
+  void loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+      auto next_deadline = clock::time_point::max();
+      for (const auto& [id, e] : running) next_deadline = std::min(next_deadline, e.deadline);
+      if (next_deadline == clock::time_point::max()) {
+        cv.wait(lock);
+        continue;
+      }
+      cv.wait_until(lock, next_deadline);
+      auto now = clock::now();
+      for (const auto& [id, e] : running) {
+        if (e.deadline <= now) {
+          entry overdue = e;
+          lock.unlock();
+          report(*overdue.test,
+              std::chrono::duration<double, std::nano>(now - overdue.started).count(),
+              std::chrono::duration<double, std::nano>(overdue.deadline - overdue.started).count());
+          lock.lock();
+          break;
+        }
+      }
+    }
+  }
+};
+
+// Results of previous runs (--cache=PATH): the file is an array of fixed-size records sorted by key,
+// mapped into memory as it is, so loading costs an mmap() and a lookup is a binary search.
+struct result_cache {
+  enum : uint32_t { passed = 1, failed = 2 };
+
+  struct entry {
+    uint64_t key;  // hash of suite.name
+    uint64_t build;  // id of the binary which ran the test
+    float wall_ns;
+    uint32_t status;
+  };
+  struct header {
+    char magic[8];
+    uint64_t count;
+  };
+  static constexpr char magic[8] = {'S', 'T', 'C', 'A', 'C', 'H', 'E', '1'};
+
+  void* m_map = nullptr;
+  size_t m_map_size = 0;
+  const entry* m_begin = nullptr;
+  const entry* m_end = nullptr;
+
+  result_cache() = default;
+  result_cache(const result_cache&) = delete;
+  ~result_cache() {
+    if (m_map) munmap(m_map, m_map_size);
+  }
+
+  static uint64_t key(const char* suite, const char* name) {
+    uint64_t h = 14695981039346656037ull;  // FNV-1a
+    for (const char* s : {suite, ".", name}) {
+      for ( ; *s; ++s) h = (h ^ static_cast<unsigned char>(*s)) * 1099511628211ull;
+    }
+    return h;
+  }
+
+  // GNU build ID of the program; if there is none, the size and the time of the executable
+  static uint64_t build_id() {
+    static const uint64_t id = [] {
+      uint64_t h = 0;
+      dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) {
+        // the first object is the program itself
+        for (int i = 0; i != info->dlpi_phnum; ++i) {
+          const auto& ph = info->dlpi_phdr[i];
+          if (ph.p_type != PT_NOTE) continue;
+          auto p = reinterpret_cast<const char*>(info->dlpi_addr + ph.p_vaddr);
+          auto end = p + ph.p_memsz;
+          while (p + sizeof(ElfW(Nhdr)) <= end) {
+            auto note = reinterpret_cast<const ElfW(Nhdr)*>(p);
+            const char* name = p + sizeof(ElfW(Nhdr));
+            const char* desc = name + ((note->n_namesz + 3) & ~3u);
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && memcmp(name, "GNU", 4) == 0) {
+              uint64_t& hash = *static_cast<uint64_t*>(data);
+              hash = 14695981039346656037ull;
+              for (uint32_t k = 0; k != note->n_descsz; ++k) {
+                hash = (hash ^ static_cast<unsigned char>(desc[k])) * 1099511628211ull;
+              }
+              return 1;
+            }
+            p = desc + ((note->n_descsz + 3) & ~3u);
+          }
+        }
+        return 1;
+      }, &h);
+      struct stat st{};
+      if (!h && stat("/proc/self/exe", &st) == 0) {
+        h = (static_cast<uint64_t>(st.st_size) * 1099511628211ull) ^ static_cast<uint64_t>(st.st_mtime) ^
+            (static_cast<uint64_t>(st.st_ino) << 32);
+      }
+      return h;
+    }();
+    return id;
+  }
+
+  bool load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(header)) {
+      void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        m_map = map;
+        m_map_size = st.st_size;
+      }
+    }
+    ::close(fd);
+    if (!m_map) return false;
+
+    auto h = static_cast<const header*>(m_map);
+    if (memcmp(h->magic, magic, sizeof(magic)) != 0 ||
+        h->count != (m_map_size - sizeof(header)) / sizeof(entry)) {
+      return false;  // not ours, it will be overwritten
+    }
+    m_begin = reinterpret_cast<const entry*>(h + 1);
+    m_end = m_begin + h->count;
+    return true;
+  }
+
+  const entry* find(const TestCase& t) const {
+    const uint64_t k = key(t.m_suite, t.m_name);
+    const entry* e = std::lower_bound(m_begin, m_end, k, [](const entry& x, uint64_t k) { return x.key < k; });
+    return e != m_end && e->key == k ? e : nullptr;
+  }
+
+  // what the cache knows of the test, made by this very binary
+  bool passed_here(const TestCase& t) const {
+    const entry* e = find(t);
+    return e && e->status == passed && e->build == build_id();
+  }
+  bool failed_before(const TestCase& t) const {
+    const entry* e = find(t);
+    return e && e->status == failed;
+  }
+
+  static entry record(const TestCase& t, bool test_passed) {
+    return {key(t.m_suite, t.m_name), build_id(), static_cast<float>(t.m_wall_ns), test_passed ? passed : failed};
+  }
+
+  // merges the fresh records into the old ones, and replaces the file at once
+  bool save(const std::string& path, std::vector<entry> fresh) const {
+    std::sort(fresh.begin(), fresh.end(), [](const entry& a, const entry& b) { return a.key < b.key; });
+    std::vector<entry> all;
+    all.reserve((m_end - m_begin) + fresh.size());
+    const entry* old = m_begin;
+    for (const entry& e : fresh) {
+      while (old != m_end && old->key < e.key) all.push_back(*old++);
+      if (old != m_end && old->key == e.key) ++old;
+      if (all.empty() || all.back().key != e.key) all.push_back(e);
+    }
+    all.insert(all.end(), old, m_end);
+
+    const std::string temp = path + ".tmp";
+    FILE* f = fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    header h{};
+    memcpy(h.magic, magic, sizeof(magic));
+    h.count = all.size();
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+        fwrite(all.data(), sizeof(entry), all.size(), f) == all.size();
+    ok = fclose(f) == 0 && ok;
+    if (ok) ok = rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) remove(temp.c_str());
+    return ok;
+  }
+};
+
+// Timings to compare later runs with (--save-baseline=PATH, --compare-baseline=PATH).
+// Unlike the cache, it is meant to be kept (by CI, in a repository), so it is text:
+// a line per test, its name and the samples in ns, see TestCase::timing_samples().
+struct baseline_file {
+  static constexpr std::string_view signature = "# simple_test baseline 1";
+
+  std::map<std::string, std::vector<double>> samples;  // by suite.name
+
+  static std::string key(const TestCase& t) {
+    std::ostringstream ost;
+    ost << t;
+    return ost.str();
+  }
+
+  bool load(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::string text;
+    char chunk[4096];
+    for (size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) != 0; ) text.append(chunk, n);
+    fclose(f);
+    if (!text.starts_with(signature)) return false;
+
+    std::istringstream lines(text);
+    for (std::string line; std::getline(lines, line); ) {
+      if (line.empty() || line[0] == '#') continue;
+      std::istringstream fields(line);
+      std::string name;
+      fields >> name;
+      std::vector<double>& s = samples[name];
+      s.clear();
+      for (double x; fields >> x; ) s.push_back(x);
+    }
+    return true;
+  }
+
+  const std::vector<double>* find(const TestCase& t) const {
+    auto it = samples.find(key(t));
+    return it == samples.end() ? nullptr : &it->second;
+  }
+
+  // the tests of another run (or of another shard) stay, and the file is replaced at once
+  bool save(const std::string& path) const {
+    const std::string temp = path + ".tmp";
+    FILE* f = fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fprintf(f, "%.*s\n", static_cast<int>(signature.size()), signature.data()) > 0;
+    for (const auto& [name, s] : samples) {
+      ok = ok && fputs(name.c_str(), f) >= 0;
+      for (double x : s) ok = ok && fprintf(f, " %.9g", x) > 0;
+      ok = ok && fputc('\n', f) != EOF;
+    }
+    ok = fclose(f) == 0 && ok;
+    if (ok) ok = rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) remove(temp.c_str());
+    return ok;
+  }
+};
+
+// Longest-processing-time-first schedule of tests, by their durations in previous runs (see result_cache).
+// Tests with unknown durations are expected to take the mean of the known ones.
+struct test_schedule {
+  std::vector<double> estimates;  // ns, for each test
+  size_t num_known = 0;
+  double declared_ns = 0;  // expected wall time, tests taken in their order
+  double expected_ns = 0;  // the same, longest first
+  double ideal_ns = 0;  // total / workers (or the longest test)
+  std::vector<std::deque<size_t>> queues;  // indices of tests for each worker, longest first
+
+  test_schedule(const std::vector<TestCase*>& tests, const result_cache& cache) {
+    double known_ns = 0;
+    for (const TestCase* t : tests) {
+      const result_cache::entry* e = cache.find(*t);
+      estimates.push_back(e ? e->wall_ns : -1);
+      if (e) {
+        num_known++;
+        known_ns += e->wall_ns;
+      }
+    }
+    const double mean = num_known ? known_ns / num_known : 0;
+    for (double& d : estimates) {
+      if (d < 0) d = mean;
+    }
+  }
+
+  bool empty() const { return num_known == 0; }
+
+  // greedy: each test goes to the worker which is free the first; returns the expected wall time
+  double assign(const std::vector<size_t>& order, int workers, std::vector<std::deque<size_t>>* out) const {
+    using load = std::pair<double, int>;  // busy time, worker
+    std::priority_queue<load, std::vector<load>, std::greater<load>> free_first;
+    for (int w = 0; w != workers; ++w) free_first.push({0, w});
+    if (out) out->assign(workers, {});
+    double makespan = 0;
+    for (size_t i : order) {
+      auto [busy, w] = free_first.top();
+      free_first.pop();
+      busy += estimates[i];
+      makespan = std::max(makespan, busy);
+      free_first.push({busy, w});
+      if (out) (*out)[w].push_back(i);
+    }
+    return makespan;
+  }
+
+  std::vector<size_t> longest_first() const {
+    std::vector<size_t> order(estimates.size());
+    for (size_t i = 0; i != order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return estimates[a] > estimates[b]; });
+    return order;
+  }
+
+  // keeps the tests of the shard, splitting them among the shards longest first
+  std::vector<TestCase*> shard(const std::vector<TestCase*>& tests, int index, int count) {
+    std::vector<std::deque<size_t>> shards;
+    assign(longest_first(), count, &shards);
+    std::vector<size_t> mine(shards[index].begin(), shards[index].end());
+    std::sort(mine.begin(), mine.end());  // in their order
+    std::vector<TestCase*> result;
+    std::vector<double> result_estimates;
+    for (size_t i : mine) {
+      result.push_back(tests[i]);
+      result_estimates.push_back(estimates[i]);
+    }
+    estimates = std::move(result_estimates);
+    return result;
+  }
+
+  // reorders the tests longest first and makes the queues of the workers
+  void plan(std::vector<TestCase*>& tests, int workers) {
+    std::vector<size_t> declared(tests.size());
+    for (size_t i = 0; i != declared.size(); ++i) declared[i] = i;
+    declared_ns = assign(declared, workers, nullptr);
+
+    std::vector<size_t> order = longest_first();
+    std::vector<TestCase*> sorted;
+    std::vector<double> sorted_estimates;
+    for (size_t i : order) {
+      sorted.push_back(tests[i]);
+      sorted_estimates.push_back(estimates[i]);
+    }
+    tests = std::move(sorted);
+    estimates = std::move(sorted_estimates);
+    for (size_t i = 0; i != order.size(); ++i) order[i] = i;
+    expected_ns = assign(order, workers, &queues);
+
+    double total = 0;
+    for (double d : estimates) total += d;
+    ideal_ns = std::max(total / workers, estimates.empty() ? 0 : estimates.front());
+  }
+
+  void print(const std::vector<TestCase*>& tests, int workers, double wall_ns) const {
+    double total = 0;
+    for (const TestCase* t : tests) total += t->m_wall_ns;
+    simple_print::colored_cout_line(simple_print::normal)
+        << "schedule: longest first, by " << num_known << " of " << tests.size() << " known durations";
+    simple_print::colored_cout_line(simple_print::normal)
+        << "  expected: " << format_ns(expected_ns) << " (in declaration order " << format_ns(declared_ns)
+        << ", ideal " << format_ns(ideal_ns) << ")";
+    simple_print::colored_cout_line(simple_print::normal)
+        << "  achieved: " << format_ns(wall_ns) << " (ideal " << format_ns(total / workers)
+        << ", balance " << std::fixed << std::setprecision(0) << (wall_ns > 0 ? 100 * total / workers / wall_ns : 100)
+        << "%)" << std::defaultfloat << std::setprecision(6);
+  }
+};
+
+// result files for CI (--output=xml:path, --output=json:path), in formats of GTest.
+// Each test is written as soon as it finishes, so nothing is collected in memory;
+// the tests of a suite are grouped as long as they finish one after another
+// (always, unless they run in parallel; otherwise a suite may appear several times).
+struct result_writer {
+  FILE* file = nullptr;
+  std::string current_suite;
+  int suite_tests = 0, suite_failures = 0, suite_disabled = 0;
+  double suite_ns = 0;
+  int total_tests = 0, total_failures = 0, total_disabled = 0;
+
+  virtual ~result_writer() {
+    if (file) fclose(file);
+  }
+
+  bool open(const char* path) {
+    file = fopen(path, "w");
+    if (!file) return false;
+    setvbuf(file, nullptr, _IOFBF, 1 << 16);
+    return true;
+  }
+
+  // one test is written at once
+  void test(const TestCase& t, bool disabled, const std::vector<test_failure>& failures) {
+    if (t.m_suite != current_suite) {
+      if (!current_suite.empty()) end_suite();
+      current_suite = t.m_suite;
+      suite_tests = suite_failures = suite_disabled = 0;
+      suite_ns = 0;
+      begin_suite();
+    }
+    write_test(t, disabled, failures);
+    const bool failed = !disabled && !failures.empty();
+    suite_tests++;
+    suite_failures += failed;
+    suite_disabled += disabled;
+    suite_ns += t.m_wall_ns;
+    total_tests++;
+    total_failures += failed;
+    total_disabled += disabled;
+  }
+
+  void finish(double total_ns) {
+    if (!current_suite.empty()) end_suite();
+    end_document(total_ns);
+    fflush(file);
+  }
+
+  virtual void begin_document() = 0;
+  virtual void end_document(double total_ns) = 0;
+  virtual void begin_suite() = 0;
+  virtual void end_suite() = 0;
+  virtual void write_test(const TestCase& t, bool disabled, const std::vector<test_failure>& failures) = 0;
+
+  static std::string timestamp() {
+    time_t now = time(nullptr);
+    tm local{};
+    localtime_r(&now, &local);
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &local);
+    return text;
+  }
+
+  static std::string location(const test_failure& f) {
+    return f.file.empty() ? f.message : f.file + ":" + std::to_string(f.line) + "\n" + f.message;
+  }
+
+  // the known performance counters, as `<prefix>cache_misses<infix>123`
+  void counters(const TestCase& t, const char* prefix, const char* infix) {
+    if (!perf_counters::enabled()) return;
+    for (size_t i = 0; i != perf_counter_count; ++i) {
+      if (std::isnan(t.m_counters[i])) continue;
+      fputs(prefix, file);
+      for (const char* c = perf_counters::names[i]; *c; ++c) fputc(*c == '-' ? '_' : *c, file);
+      fprintf(file, "%s%.10g", infix, t.m_counters[i]);
+    }
+  }
+};
+
+// GTest's (JUnit-like) XML. The counts of an element are known when it ends,
+// so they are written over the space reserved in its opening tag.
+struct xml_result_writer : result_writer {
+  static constexpr int counts_width = 128;
+  long document_counts = -1;
+  long suite_counts = -1;
+
+  void escape(std::string_view text) {
+    for (char c : text) {
+      switch (c) {
+        case '<': fputs("&lt;", file); break;
+        case '>': fputs("&gt;", file); break;
+        case '&': fputs("&amp;", file); break;
+        case '"': fputs("&quot;", file); break;
+        case '\n': fputs("&#x0A;", file); break;
+        case '\r': fputs("&#x0D;", file); break;
+        case '\t': fputs("&#x09;", file); break;
+        default:
+          if (c >= 0 && c < 32) c = '?';  // not allowed in XML 1.0
+          fputc(c, file);
+      }
+    }
+  }
+
+  void reserve_counts(long& position) {
+    position = ftell(file);  // -1 if the file is not seekable, then the space stays blank
+    fprintf(file, "%*s", counts_width, "");
+  }
+  void write_counts(long position, int tests, int failures, int disabled, double ns) {
+    if (position < 0 || fseek(file, position, SEEK_SET) != 0) return;
+    fprintf(file, "tests=\"%d\" failures=\"%d\" disabled=\"%d\" errors=\"0\" time=\"%.3f\"",
+        tests, failures, disabled, ns * 1e-9);
+    fseek(file, 0, SEEK_END);
+  }
+
+  void begin_document() override {
+    fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites ", file);
+    reserve_counts(document_counts);
+    fprintf(file, " timestamp=\"%s\" name=\"AllTests\">\n", timestamp().c_str());
+  }
+  void end_document(double total_ns) override {
+    fputs("</testsuites>\n", file);
+    write_counts(document_counts, total_tests, total_failures, total_disabled, total_ns);
+  }
+  void begin_suite() override {
+    fputs("  <testsuite name=\"", file);
+    escape(current_suite);
+    fputs("\" ", file);
+    reserve_counts(suite_counts);
+    fputs(">\n", file);
+  }
+  void end_suite() override {
+    fputs("  </testsuite>\n", file);
+    write_counts(suite_counts, suite_tests, suite_failures, suite_disabled, suite_ns);
+  }
+  void write_test(const TestCase& t, bool disabled, const std::vector<test_failure>& failures) override {
+    fputs("    <testcase name=\"", file);
+    escape(t.m_name);
+    fprintf(file, "\" status=\"%s\" result=\"%s\" time=\"%.3f\" classname=\"",
+        disabled ? "notrun" : "run", disabled ? "suppressed" : "completed", t.m_wall_ns * 1e-9);
+    escape(t.m_suite);
+    if (allocation_counting() && !disabled) {
+      fprintf(file, "\" allocations=\"%llu\" allocated_bytes=\"%llu\" peak_bytes=\"%lld",
+          static_cast<unsigned long long>(t.m_allocs), static_cast<unsigned long long>(t.m_alloc_bytes),
+          static_cast<long long>(t.m_peak_bytes));
+    }
+    if (!disabled) counters(t, "\" ", "=\"");
+    if (disabled || failures.empty()) {
+      fputs("\" />\n", file);
+      return;
+    }
+    fputs("\">\n", file);
+    for (const test_failure& f : failures) {
+      std::string text = location(f);
+      fputs("      <failure message=\"", file);
+      escape(text);
+      fputs("\" type=\"\"><![CDATA[", file);
+      // "]]>" can't be inside CDATA
+      for (size_t begin = 0, end; begin < text.size(); begin = end) {
+        end = text.find("]]>", begin);
+        end = end == std::string::npos ? text.size() : end + 2;
+        fwrite(text.data() + begin, 1, end - begin, file);
+        if (end != text.size()) fputs("]]><![CDATA[", file);
+      }
+      fputs("]]></failure>\n", file);
+    }
+    fputs("    </testcase>\n", file);
+  }
+};
+
+// GTest's JSON. The counts of an object go after its items, so nothing is written twice.
+struct json_result_writer : result_writer {
+  bool first_suite = true;
+  bool first_test = true;
+
+  void string(std::string_view text) {
+    static constexpr char hex_digits[] = "0123456789abcdef";
+    fputc('"', file);
+    for (char c : text) {
+      switch (c) {
+        case '"': fputs("\\\"", file); break;
+        case '\\': fputs("\\\\", file); break;
+        case '\n': fputs("\\n", file); break;
+        case '\r': fputs("\\r", file); break;
+        case '\t': fputs("\\t", file); break;
+        default:
+          if (c >= 0 && c < 32) {
+            fprintf(file, "\\u00%c%c", hex_digits[c >> 4], hex_digits[c & 15]);
+          } else {
+            fputc(c, file);
+          }
+      }
+    }
+    fputc('"', file);
+  }
+
+  void counts(const char* indent, int tests, int failures, int disabled, double ns) {
+    fprintf(file, "%s\"tests\": %d,\n%s\"failures\": %d,\n%s\"disabled\": %d,\n%s\"errors\": 0,\n%s\"time\": \"%.3fs\"",
+        indent, tests, indent, failures, indent, disabled, indent, indent, ns * 1e-9);
+  }
+
+  void begin_document() override {
+    fprintf(file, "{\n  \"name\": \"AllTests\",\n  \"timestamp\": \"%s\",\n  \"testsuites\": [", timestamp().c_str());
+  }
+  void end_document(double total_ns) override {
+    fputs(first_suite ? "],\n" : "\n  ],\n", file);
+    counts("  ", total_tests, total_failures, total_disabled, total_ns);
+    fputs("\n}\n", file);
+  }
+  void begin_suite() override {
+    fputs(first_suite ? "\n    {\n      \"name\": " : ",\n    {\n      \"name\": ", file);
+    first_suite = false;
+    first_test = true;
+    string(current_suite);
+    fputs(",\n      \"testsuite\": [", file);
+  }
+  void end_suite() override {
+    fputs("\n      ],\n", file);
+    counts("      ", suite_tests, suite_failures, suite_disabled, suite_ns);
+    fputs("\n    }", file);
+  }
+  void write_test(const TestCase& t, bool disabled, const std::vector<test_failure>& failures) override {
+    fputs(first_test ? "\n        {\n          \"name\": " : ",\n        {\n          \"name\": ", file);
+    first_test = false;
+    string(t.m_name);
+    fprintf(file, ",\n          \"status\": \"%s\",\n          \"result\": \"%s\",\n          \"time\": \"%.3fs\",\n"
+        "          \"classname\": ",
+        disabled ? "NOTRUN" : "RUN", disabled ? "SUPPRESSED" : "COMPLETED", t.m_wall_ns * 1e-9);
+    string(t.m_suite);
+    if (allocation_counting() && !disabled) {
+      fprintf(file, ",\n          \"allocations\": %llu,\n          \"allocated_bytes\": %llu,\n"
+          "          \"peak_bytes\": %lld",
+          static_cast<unsigned long long>(t.m_allocs), static_cast<unsigned long long>(t.m_alloc_bytes),
+          static_cast<long long>(t.m_peak_bytes));
+    }
+    if (!disabled) counters(t, ",\n          \"", "\": ");
+    if (!disabled && !failures.empty()) {
+      fputs(",\n          \"failures\": [", file);
+      const char* sep = "\n";
+      for (const test_failure& f : failures) {
+        fputs(sep, file);
+        fputs("            {\n              \"failure\": ", file);
+        string(location(f));
+        fputs(",\n              \"type\": \"\"\n            }", file);
+        sep = ",\n";
+      }
+      fputs("\n          ]", file);
+    }
+    fputs("\n        }", file);
+  }
+};
+
+// all the result files of the run
+struct result_files {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<result_writer>> writers;
+
+  static result_files& instance() {
+    static result_files r;
+    return r;
+  }
+
+  // specs are "xml:path" or "json:path"
+  void open(const std::vector<std::string>& specs) {
+    writers.clear();
+    for (const std::string& spec : specs) {
+      std::unique_ptr<result_writer> w;
+      std::string path;
+      if (spec.starts_with("xml:")) {
+        w.reset(new xml_result_writer);
+        path = spec.substr(4);
+      } else if (spec.starts_with("json:")) {
+        w.reset(new json_result_writer);
+        path = spec.substr(5);
+      } else {
+        std::cerr << "unknown output format: " << spec << " (xml:path or json:path expected)" << std::endl;
+        continue;
+      }
+      if (!w->open(path.c_str())) {
+        std::cerr << "can't write " << path << ": " << strerror(errno) << std::endl;
+        continue;
+      }
+      w->begin_document();
+      writers.push_back(std::move(w));
+    }
+  }
+
+  bool empty() const { return writers.empty(); }
+
+  void test(const TestCase& t, bool disabled, const std::vector<test_failure>& failures) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& w : writers) w->test(t, disabled, failures);
+  }
+
+  // writes the test and lets its failures go
+  void test(TestCase& t) {
+    if (empty()) return;
+    if (!t.m_passed && t.m_failures.empty()) t.m_failures.push_back({"", 0, "failed"});
+    static const std::vector<test_failure> none;
+    test(t, false, t.m_passed ? none : t.m_failures);
+    t.m_failures = {};
+  }
+
+  void close(double total_ns) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& w : writers) w->finish(total_ns);
+    writers.clear();
+  }
+};
+
+inline void TestCase::run_benchmark(const run_options& options) {
+  benchmark_state state;
+  m_bench_samples = measure_benchmark(m_bench_func, state, options, m_counters);
+  benchmark_stats stats(m_bench_samples);
+
+  simple_print::colored_cout_line(simple_print::normal)
+      << "  time per iteration: mean " << format_ns(stats.mean)
+      << ", median " << format_ns(stats.median)
+      << ", stddev " << format_ns(stats.stddev)
+      << ", min " << format_ns(stats.min);
+  simple_print::colored_cout_line(simple_print::normal)
+      << "  iterations: " << state.m_iterations << " x " << m_bench_samples.size() << " samples";
+  if (state.m_bytes || state.m_items) {
+    simple_print::colored_cout_line line(simple_print::normal);
+    line << "  throughput:";
+    if (state.m_bytes) line << " " << format_si(state.m_bytes * 1e9 / stats.mean) << "B/s";
+    if (state.m_items) line << " " << format_si(state.m_items * 1e9 / stats.mean) << "items/s";
+  }
+}
+
+inline void TestCase::fail(const std::string& reason) {
+  m_passed = false;
+  m_failures.push_back({"", 0, reason});
+  simple_print::colored_cout_line(simple_print::red) << *this << " " << reason;
+}
+
+// an exception in a part fails the test
+template<class F> void TestCase::guarded(const char* part, F&& func) {
+  try {
+    func();
+  } catch (assertion_fault) {
+    m_passed = false;
+  } catch (const std::exception& e) {
+    fail(part + std::string("raised ") + e.what());
+  } catch (...) {
+    fail(part + std::string("raised an exception"));
+  }
+}
+
+inline void TestCase::set_up_suite() {
+  if (!m_suite_fixture) return;
+  guarded("SetUpTestSuite ", [&] {
+    if (!m_suite_fixture->enter()) fail("SetUpTestSuite has failed in another test");
+  });
+}
+
+// The event loop of ASYNC_TESTs: resumes the coroutines whose deadlines have come,
+// whose file descriptors are ready (by epoll), and whose futures are ready (polled each round).
+// Each waiter is stamped with the context of the coroutine which is being resumed (its test).
+struct epoll_loop final : async_loop {
+  struct timer {
+    clock::time_point deadline;
+    uint64_t order;  // of the same deadlines, the first come is the first served
+    async_waiter* waiter;
+    bool operator > (const timer& other) const {
+      return std::tie(deadline, order) > std::tie(other.deadline, other.order);
+    }
+  };
+
+  int m_epoll = -1;
+  async_loop* m_outer = nullptr;
+  void* m_context = nullptr;  // of the coroutine being resumed
+  std::priority_queue<timer, std::vector<timer>, std::greater<>> m_timers;
+  uint64_t m_timer_count = 0;
+  std::vector<async_waiter*> m_polled;
+  size_t m_fd_waiters = 0;
+  std::deque<async_waiter*> m_ready;
+
+  epoll_loop() : m_epoll(epoll_create1(EPOLL_CLOEXEC)), m_outer(std::exchange(current(), this)) {
+    if (m_epoll < 0) throw std::runtime_error(std::string("epoll_create1: ") + strerror(errno));
+  }
+  epoll_loop(const epoll_loop&) = delete;
+  ~epoll_loop() {
+    current() = m_outer;
+    if (m_epoll >= 0) ::close(m_epoll);
+  }
+
+  void at(clock::time_point deadline, async_waiter& w) override {
+    w.context = m_context;
+    m_timers.push({deadline, m_timer_count++, &w});
+  }
+
+  void on_fd(int fd, uint32_t events, async_waiter& w) override {
+    w.context = m_context;
+    w.fd = fd;
+    w.events = events;
+    epoll_event e{};
+    e.events = events | EPOLLONESHOT;
+    e.data.ptr = &w;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &e) == 0) {
+      m_fd_waiters++;
+    } else if (errno == EPERM) {
+      m_ready.push_back(&w);  // a regular file, which is always ready
+    } else if (errno == EEXIST) {
+      // another coroutine waits for this descriptor, so this one polls it
+      w.is_ready = [](async_waiter& w) {
+        pollfd p{w.fd, static_cast<short>(w.events), 0};
+        if (::poll(&p, 1, 0) <= 0) return false;
+        w.events = static_cast<uint16_t>(p.revents);
+        return true;
+      };
+      m_polled.push_back(&w);
+    } else {
+      throw std::runtime_error("can't wait for descriptor " + std::to_string(fd) + ": " + strerror(errno));
+    }
+  }
+
+  void poll(async_waiter& w) override {
+    w.context = m_context;
+    m_polled.push_back(&w);
+  }
+
+  bool idle() const { return m_timers.empty() && m_polled.empty() && !m_fd_waiters && m_ready.empty(); }
+
+  // waits for the next events, no longer than until the nearest deadline
+  // (or for a millisecond if there is something to poll)
+  void wait() {
+    std::erase_if(m_polled, [this](async_waiter* w) {
+      if (!w->is_ready(*w)) return false;
+      m_ready.push_back(w);
+      return true;
+    });
+    int timeout_ms = -1;
+    if (!m_ready.empty()) {
+      timeout_ms = 0;
+    } else if (!m_timers.empty()) {
+      const auto left = m_timers.top().deadline - clock::now();
+      timeout_ms = static_cast<int>(std::max<int64_t>(0,
+          std::chrono::ceil<std::chrono::milliseconds>(left).count()));
+    }
+    if (!m_polled.empty() && (timeout_ms < 0 || timeout_ms > 1)) timeout_ms = 1;
+
+    epoll_event events[64];
+    const int n = epoll_wait(m_epoll, events, std::size(events), timeout_ms);
+    for (int i = 0; i < n; ++i) {
+      auto w = static_cast<async_waiter*>(events[i].data.ptr);
+      epoll_ctl(m_epoll, EPOLL_CTL_DEL, w->fd, nullptr);
+      m_fd_waiters--;
+      w->events = events[i].events;
+      m_ready.push_back(w);
+    }
+    for (const auto now = clock::now(); !m_timers.empty() && m_timers.top().deadline <= now; m_timers.pop()) {
+      m_ready.push_back(m_timers.top().waiter);
+    }
+  }
+
+  async_waiter* next() {
+    if (m_ready.empty()) return nullptr;
+    async_waiter* w = m_ready.front();
+    m_ready.pop_front();
+    return w;
+  }
+
+  void resume(void* context, std::coroutine_handle<> h) {
+    void* outer = std::exchange(m_context, context);
+    h.resume();
+    m_context = outer;
+  }
+  void resume(async_waiter& w) { resume(w.context, w.handle); }
+};
+
+// an ASYNC_TEST alone (in a child process, or called directly), on a loop of its own
+inline void TestCase::run_async_body() {
+  epoll_loop loop;
+  task<> body = m_async_func();
+  loop.resume(nullptr, body.m_handle);
+  while (!body.done()) {
+    if (loop.idle()) throw std::runtime_error("the coroutine is suspended, but waits for nothing of the loop");
+    loop.wait();
+    while (async_waiter* w = loop.next()) loop.resume(*w);
+  }
+  body.await_resume();  // rethrows what has stopped it
+}
+
+// runs the test in the current thread and prints its verdict
+inline void TestCase::run(const run_options& options) {
+  current() = this;
+  const bool sole = options.jobs <= 1 || options.isolate || options.bench;  // or a child runs it alone
+  if (sole) sole_running() = this;
+  bool old_green_assertions = show_green_assertions(m_show_green_assertions);
+
+  m_called = true;
+  simple_print::colored_cout_line(simple_print::blue) << *this << " running...";
+  simple_print::colored_cout_line(simple_print::blue) << simple_print::bar;
+  allocation_counters& allocations = thread_allocations();
+  allocations.peak = allocations.live;
+  m_alloc_start = allocations;
+  const auto wall_start = std::chrono::steady_clock::now();
+  const double cpu_start = thread_cpu_ns();
+  const uint64_t watch_id = is_benchmark() ? 0 : watchdog::instance().begin(this, timeout_ms(options));
+  m_failures.clear();
+  m_thread_output.clear();
+  std::fill(std::begin(m_counters), std::end(m_counters), NAN);
+  const bool count = perf_counters::enabled() && !is_benchmark();  // benchmarks count their samples
+  if (count) perf_counters::instance().start();
+  m_passed = true;  // could be reset in the func
+  set_up_suite();
+  if (m_passed) {
+    guarded("", [&] {
+      if (is_benchmark()) {
+        run_benchmark(options);
+      } else if (m_async_func) {
+        run_async_body();
+      } else if (m_param_func) {
+        m_param_func(*m_param_source, m_param_index);
+      } else {
+        m_func();
+      }
+    });
+  }
+  if (m_suite_fixture) guarded("TearDownTestSuite ", [&] { m_suite_fixture->leave(); });
+  if (sole) sole_running() = nullptr;
+  if (count) perf_counters::instance().stop(m_counters);
+  watchdog::instance().end(watch_id);
+  m_wall_ns = elapsed_ns(wall_start);
+  m_cpu_ns = thread_cpu_ns() - cpu_start;
+  m_allocs = allocations.allocs - m_alloc_start.allocs;
+  m_alloc_bytes = allocations.bytes - m_alloc_start.bytes;
+  m_peak_bytes = allocations.peak - m_alloc_start.live;
+  take_thread_output(this);  // of threads which are not joined by test_thread
+
+  print_verdict(options);
+
+  show_green_assertions(old_green_assertions);
+  current() = nullptr;
+  finish_output(options);
+}
+
+// writes out the whole output of the test at once;
+// when the tests are repeated, only the first failure of each one is shown
+inline void TestCase::finish_output(const run_options& options) const {
+  if (!options.repeating() || (!m_passed && !m_failed_runs)) {
+    simple_print::flush_output();
+  } else {
+    simple_print::thread_output::instance().buf.text.clear();
+  }
+}
+
+// after the test has run (here or in a child process)
+inline void TestCase::record_run(const run_options& options) {
+  m_runs++;
+  m_failed_runs += !m_passed;
+  if (options.repeating()) m_run_ns.push_back(m_wall_ns);
+}
+
+inline bool TestCase::is_slow(const run_options& options) const {
+  return options.slow_threshold_ms > 0 && m_wall_ns > options.slow_threshold_ms * 1e6;
+}
+
+inline void TestCase::print_verdict(const run_options& options) const {
+  if (is_slow(options)) {
+    simple_print::colored_cout_line(simple_print::yellow)
+        << *this << " is slow: " << format_ns(m_wall_ns)
+        << " > " << format_ns(options.slow_threshold_ms * 1e6);
+  }
+  auto color = m_passed ? simple_print::green : simple_print::red;
+  simple_print::colored_cout_line(color) << simple_print::bar;
+  {
+    simple_print::colored_cout_line line(color);
+    line << *this << (m_passed ? " PASSED" : " FAILED")
+        << " (" << format_ns(m_wall_ns) << ", cpu " << format_ns(m_cpu_ns);
+    if (allocation_counting()) {
+      line << ", " << m_allocs << " allocs of " << format_si(m_alloc_bytes) << "B"
+          << ", peak " << format_si(m_peak_bytes) << "B";
+    }
+    line << ")";
+  }
+  if (perf_counters::enabled()) {
+    simple_print::colored_cout_line line(simple_print::normal);
+    line << (is_benchmark() ? "  counters per iteration:" : "  counters:");
+    print_counters(line.ost(), m_counters);
+  }
+  simple_print::colored_cout_line(simple_print::normal) << "";
+}
+
+// runs tests in a pool of child processes, each child runs tests one by one
+// until it crashes; then a new child is forked to continue
+inline void TestCase::run_isolated(const std::vector<TestCase*>& tests, const run_options& options) {
+  struct child {
+    pid_t pid = -1;
+    int to_child = -1;
+    int from_child = -1;
+    size_t test = SIZE_MAX;  // currently running test
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point deadline;
+    std::string output;  // output of the current test
+  };
+  std::vector<child> children(std::min<size_t>(options.jobs, tests.size()));
+
+  auto child_main = [&tests, &options](int in, int out) {
+    isolated::parent_fd() = out;
+    simple_print::output_sink() = isolated::send_output;
+    for (uint32_t index; isolated::read_all(in, &index, sizeof(index)) && index != isolated::quit; ) {
+      TestCase* t = tests[index];
+      t->run(options);
+      std::cout.flush();
+      isolated::result result{t->m_wall_ns, t->m_cpu_ns, t->m_allocs, t->m_alloc_bytes, t->m_peak_bytes, {},
+          static_cast<uint32_t>(t->m_bench_samples.size())};
+      std::copy(std::begin(t->m_counters), std::end(t->m_counters), result.counters);
+      std::string payload(reinterpret_cast<const char*>(&result), sizeof(result));
+      payload.append(reinterpret_cast<const char*>(t->m_bench_samples.data()),
+          t->m_bench_samples.size() * sizeof(double));
+      payload += isolated::write_failures(t->m_failures);
+      isolated::send(out, t->m_passed ? isolated::passed : isolated::failed,
+          payload.data(), static_cast<uint32_t>(payload.size()));
+    }
+    // the child has set up the suites of its tests by itself, and can't know their last test
+    for (TestCase* t : tests) {
+      suite_fixture* fixture = t->m_suite_fixture;
+      if (!fixture || fixture->state != suite_fixture::ready) continue;
+      current() = t;  // for assertions of TearDownTestSuite, which are not reported
+      fixture->pending = 0;
+      try { fixture->leave(); } catch (...) {}
+    }
+    std::cout.flush();
+    _exit(0);
+  };
+
+  auto spawn = [&](child& c) {
+    int down[2], up[2];
+    if (pipe(down) != 0 || pipe(up) != 0) {
+      perror("pipe");
+      abort();
+    }
+    std::cout.flush();
+    simple_print::flush_output();
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      abort();
+    }
+    if (pid == 0) {
+      for (const child& other : children) {
+        if (other.pid > 0) {
+          close(other.to_child);
+          close(other.from_child);
+        }
+      }
+      close(down[1]);
+      close(up[0]);
+      child_main(down[0], up[1]);
+    }
+    close(down[0]);
+    close(up[1]);
+    c.pid = pid;
+    c.to_child = down[1];
+    c.from_child = up[0];
+  };
+
+  auto reap = [](child& c) {
+    close(c.to_child);
+    close(c.from_child);
+    int status = 0;
+    while (waitpid(c.pid, &status, 0) < 0 && errno == EINTR) {}
+    c.pid = -1;
+    return status;
+  };
+
+  auto print_output = [&options](const child& c, const TestCase& t) {
+    OUTPUT_STREAM() << c.output;
+    t.finish_output(options);
+  };
+
+  size_t next = 0;
+  auto assign = [&](child& c) {
+    while (next < tests.size()) {
+      uint32_t index = static_cast<uint32_t>(next);
+      if (isolated::write_all(c.to_child, &index, sizeof(index))) {
+        c.test = next++;
+        c.started = std::chrono::steady_clock::now();
+        c.deadline = std::chrono::steady_clock::time_point::max();
+        if (double timeout = tests[c.test]->timeout_ms(options); timeout > 0) {
+          c.deadline = c.started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double, std::milli>(timeout));
+        }
+        c.output.clear();
+        return;
+      }
+      reap(c);  // the child is dead already, try a new one
+      spawn(c);
+    }
+    uint32_t index = isolated::quit;
+    isolated::write_all(c.to_child, &index, sizeof(index));
+    reap(c);
+  };
+
+  // a dead child shall not kill the parent
+  auto old_sigpipe = signal(SIGPIPE, SIG_IGN);
+
+  for (child& c : children) {
+    spawn(c);
+    assign(c);
+  }
+
+  // SIGTERM lets the child write out the collected output, then SIGKILL if it doesn't die
+  auto terminate = [&](child& c) {
+    kill(c.pid, SIGTERM);
+    for (;;) {
+      pollfd fd{c.from_child, POLLIN, 0};
+      if (poll(&fd, 1, 100) <= 0) {
+        kill(c.pid, SIGKILL);
+        break;
+      }
+      isolated::message msg;
+      if (!isolated::read_all(c.from_child, &msg, sizeof(msg)) || msg.kind != isolated::output) break;
+      std::string text(msg.size, '\0');
+      if (!isolated::read_all(c.from_child, text.data(), text.size())) break;
+      c.output += text;
+    }
+    return reap(c);
+  };
+
+  // the child has crashed or has been killed in the middle of the test
+  auto fail = [&](child& c, int status, bool timed_out) {
+    TestCase* t = tests[c.test];
+    t->m_called = true;
+    t->m_passed = false;
+    t->m_wall_ns = elapsed_ns(c.started);
+    t->m_cpu_ns = 0;  // unknown
+    std::fill(std::begin(t->m_counters), std::end(t->m_counters), NAN);
+    OUTPUT_STREAM() << c.output;
+    std::string reason = timed_out
+        ? "timed out: " + format_ns(t->m_wall_ns) + " > " + format_ns(t->timeout_ms(options) * 1e6) + ", killed"
+        : "crashed: " + isolated::exit_status(status);
+    simple_print::colored_cout_line(simple_print::red) << *t << " " << reason;
+    t->print_verdict(options);
+    t->finish_output(options);
+    t->m_failures = {{"", 0, reason}};
+    result_files::instance().test(*t);
+    t->record_run(options);
+
+    spawn(c);
+    assign(c);
+  };
+
+  std::vector<pollfd> fds;
+  for (;;) {
+    fds.clear();
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    for (const child& c : children) {
+      if (c.pid > 0) {
+        fds.push_back(pollfd{c.from_child, POLLIN, 0});
+        deadline = std::min(deadline, c.deadline);
+      }
+    }
+    if (fds.empty()) break;
+    int timeout = -1;
+    if (deadline != std::chrono::steady_clock::time_point::max()) {
+      auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+      timeout = static_cast<int>(std::max<long long>(0, left.count()));
+    }
+    if (poll(fds.data(), fds.size(), timeout) < 0) {
+      if (errno == EINTR) continue;
+      perror("poll");
+      abort();
+    }
+
+    // hung tests are killed with their children
+    bool killed = false;
+    for (child& c : children) {
+      if (c.pid > 0 && c.deadline <= std::chrono::steady_clock::now()) {
+        fail(c, terminate(c), true);
+        killed = true;
+      }
+    }
+    if (killed) continue;  // fds may be reused by new children
+
+    for (const pollfd& fd : fds) {
+      if (!fd.revents) continue;
+      child& c = *std::find_if(children.begin(), children.end(),
+          [&fd](const child& x) { return x.pid > 0 && x.from_child == fd.fd; });
+      TestCase* t = tests[c.test];
+
+      isolated::message msg;
+      if (isolated::read_all(c.from_child, &msg, sizeof(msg))) {
+        if (msg.kind == isolated::output) {
+          std::string text(msg.size, '\0');
+          if (isolated::read_all(c.from_child, text.data(), text.size())) {
+            c.output += text;
+            continue;
+          }
+        } else {
+          isolated::result result{};
+          std::string payload(msg.size, '\0');
+          if (msg.size >= sizeof(result) && isolated::read_all(c.from_child, payload.data(), payload.size())) {
+            memcpy(&result, payload.data(), sizeof(result));
+            t->m_called = true;
+            t->m_passed = msg.kind == isolated::passed;
+            t->m_wall_ns = result.wall_ns;
+            t->m_cpu_ns = result.cpu_ns;
+            t->m_allocs = result.allocs;
+            t->m_alloc_bytes = result.alloc_bytes;
+            t->m_peak_bytes = result.peak_bytes;
+            std::copy(std::begin(result.counters), std::end(result.counters), t->m_counters);
+            std::string_view rest = std::string_view(payload).substr(sizeof(result));
+            const size_t samples_size = std::min<size_t>(rest.size() / sizeof(double), result.bench_samples);
+            t->m_bench_samples.resize(samples_size);
+            if (samples_size) memcpy(t->m_bench_samples.data(), rest.data(), samples_size * sizeof(double));
+            t->m_failures = isolated::read_failures(rest.substr(samples_size * sizeof(double)));
+            print_output(c, *t);
+            result_files::instance().test(*t);
+            t->record_run(options);
+            assign(c);
+            continue;
+          }
+        }
+      }
+
+      fail(c, reap(c), false);
+    }
+  }
+
+  signal(SIGPIPE, old_sigpipe);
+}
+
+// runs ASYNC_TESTs at once, interleaved on this thread by an epoll_loop, so they take the time
+// of the longest one, not the sum; a coroutine is resumed as a part of its test (for the assertions),
+// with cpu time and allocations counted to it, and its output is kept apart until the test finishes
+inline void TestCase::run_async(const std::vector<TestCase*>& tests, const run_options& options) {
+  struct running {
+    TestCase* test = nullptr;
+    std::optional<task<>> body;
+    std::chrono::steady_clock::time_point start;
+    uint64_t watch_id = 0;
+  };
+  std::vector<running> runs(tests.size());
+  size_t num_running = 0;
+  epoll_loop loop;
+  allocation_counters& allocations = thread_allocations();
+
+  auto as_part_of = [&](TestCase* t, auto&& func) {
+    current() = t;
+    const bool old_green_assertions = show_green_assertions(t->m_show_green_assertions);
+    const allocation_counters before = allocations;
+    allocations.peak = allocations.live;
+    const double cpu_start = thread_cpu_ns();
+    func();
+    t->m_cpu_ns += thread_cpu_ns() - cpu_start;
+    t->m_allocs += allocations.allocs - before.allocs;
+    t->m_alloc_bytes += allocations.bytes - before.bytes;
+    t->m_peak_bytes = std::max(t->m_peak_bytes, allocations.peak - before.live);
+    show_green_assertions(old_green_assertions);
+    current() = nullptr;
+    std::string& text = simple_print::thread_output::instance().buf.text;
+    std::lock_guard<std::mutex> lock(failures_mutex());
+    t->m_thread_output += text;
+    text.clear();
+  };
+
+  auto finish = [&](running& r) {
+    TestCase* t = r.test;
+    as_part_of(t, [&] {
+      if (r.body) t->guarded("", [&] { r.body->await_resume(); });
+      r.body.reset();
+      if (t->m_suite_fixture) t->guarded("TearDownTestSuite ", [&] { t->m_suite_fixture->leave(); });
+    });
+    watchdog::instance().end(r.watch_id);
+    t->m_wall_ns = elapsed_ns(r.start);
+    current() = t;
+    take_thread_output(t);
+    t->print_verdict(options);
+    current() = nullptr;
+    t->finish_output(options);
+    result_files::instance().test(*t);
+    t->record_run(options);
+  };
+
+  for (size_t i = 0; i != tests.size(); ++i) {
+    running& r = runs[i];
+    TestCase* t = r.test = tests[i];
+    t->m_called = true;
+    t->m_passed = true;
+    t->m_failures.clear();
+    t->m_thread_output.clear();
+    std::fill(std::begin(t->m_counters), std::end(t->m_counters), NAN);  // they can't tell one test from another
+    t->m_cpu_ns = 0;
+    t->m_allocs = t->m_alloc_bytes = 0;
+    t->m_peak_bytes = 0;
+    r.start = std::chrono::steady_clock::now();
+    r.watch_id = watchdog::instance().begin(t, t->timeout_ms(options));
+    as_part_of(t, [&] {
+      simple_print::colored_cout_line(simple_print::blue) << *t << " running...";
+      simple_print::colored_cout_line(simple_print::blue) << simple_print::bar;
+      t->set_up_suite();
+      if (t->m_passed) {
+        t->guarded("", [&] {
+          r.body.emplace(t->m_async_func());
+          loop.resume(&r, r.body->m_handle);
+        });
+      }
+    });
+    if (r.body && !r.body->done()) {
+      num_running++;
+    } else {
+      finish(r);
+    }
+  }
+
+  while (num_running) {
+    if (loop.idle()) {
+      for (running& r : runs) {
+        if (!r.body) continue;
+        as_part_of(r.test, [&] { r.test->fail("is suspended, but waits for nothing of the loop"); });
+        num_running--;
+        finish(r);
+      }
+      break;
+    }
+    loop.wait();
+    while (async_waiter* w = loop.next()) {
+      running& r = *static_cast<running*>(w->context);
+      as_part_of(r.test, [&] { loop.resume(*w); });
+      if (r.body->done()) {
+        num_running--;
+        finish(r);
+      }
+    }
+  }
+}
+
+template<class Filter> bool TestCase::run_all(Filter name_filter, const run_options& options) {
+  int num_skipped = 0;
+  int num_cached = 0;
+
+  result_files& results = result_files::instance();
+  results.open(options.outputs);
+
+  if (options.counters) {
+    std::string note = perf_counters::probe(options.counters);
+    if (!note.empty()) simple_print::colored_cout_line(simple_print::yellow) << "counters: " << note;
+    simple_print::flush_output();
+  }
+
+  result_cache cache;
+  const bool use_cache = !options.cache_path.empty() && !options.bench;
+  if (use_cache) cache.load(options.cache_path);
+
+  std::vector<TestCase*> tests;
+  for (TestCase* t : test_registry::instance().tests) {
+    if (t->is_benchmark() != options.bench || !name_filter(t->m_suite, t->m_name)) {
+      continue;
+    }
+
+    if (!t->is_enabled()) {
+      num_skipped++;
+      if (!results.empty()) results.test(*t, true, {});
+      continue;
+    }
+
+    if (options.only_changed && cache.passed_here(*t)) {
+      num_cached++;
+      continue;
+    }
+
+    tests.push_back(t);
+  }
+
+  // by the durations of previous runs, if they are known
+  const int workers = std::min<int>(options.jobs, std::max<size_t>(tests.size(), 1));
+  test_schedule schedule(tests, cache);
+  const bool longest_first = options.longest_first && !options.bench && !schedule.empty();
+  if (options.shard_count > 1) {
+    if (longest_first) {
+      tests = schedule.shard(tests, options.shard_index, options.shard_count);
+    } else {
+      std::vector<TestCase*> mine;
+      for (size_t i = options.shard_index; i < tests.size(); i += options.shard_count) mine.push_back(tests[i]);
+      tests = std::move(mine);
+    }
+  }
+  const bool scheduled = longest_first && workers > 1 && tests.size() > 1 && !options.failed_first;
+  if (scheduled) schedule.plan(tests, workers);
+
+  if (options.failed_first) {
+    std::stable_partition(tests.begin(), tests.end(), [&cache](const TestCase* t) { return cache.failed_before(*t); });
+  }
+
+  // a suite of TEST_F is torn down when its last selected test finishes
+  for (TestCase* t : tests) {
+    if (t->m_suite_fixture) t->m_suite_fixture->pending = 0;
+  }
+  for (TestCase* t : tests) {
+    if (t->m_suite_fixture) t->m_suite_fixture->pending++;
+  }
+
+  auto save_cache = [&](const TestCase* timed_out, const std::atomic<bool>* finished) {
+    if (!use_cache) return;
+    std::vector<result_cache::entry> fresh;
+    for (size_t i = 0; i != tests.size(); ++i) {
+      if (tests[i] == timed_out) {
+        fresh.push_back(result_cache::record(*tests[i], false));
+      } else if (finished[i]) {
+        fresh.push_back(result_cache::record(*tests[i], tests[i]->m_passed));
+      }
+    }
+    cache.save(options.cache_path, std::move(fresh));
+  };
+
+  const auto run_start = std::chrono::steady_clock::now();
+  simple_print::crash_flusher::install();
+  // child processes can't share the writer thread
+  const bool async_output = options.async_output && !options.isolate;
+  if (async_output) simple_print::async_writer::instance().start();
+
+  // ASYNC_TESTs run together on this thread (unless each test runs alone), before the others
+  const bool interleave = !options.bench && !options.isolate;
+  std::vector<TestCase*> async_tests;
+  if (interleave) {
+    std::copy_if(tests.begin(), tests.end(), std::back_inserter(async_tests), std::mem_fn(&TestCase::is_async));
+  }
+
+  // for the summary after a timeout
+  std::unique_ptr<std::atomic<bool>[]> finished(new std::atomic<bool>[tests.size()]{});
+  auto run_one = [&](size_t i) {
+    if (interleave && tests[i]->is_async()) return;
+    tests[i]->run(options);
+    results.test(*tests[i]);
+    tests[i]->record_run(options);
+    finished[i] = true;
+  };
+  for (TestCase* t : tests) {
+    t->m_runs = t->m_failed_runs = 0;
+    t->m_run_ns.clear();
+  }
+
+  // in-process run can't recover from a hung test, so the watchdog stops the run
+  const bool watch = !options.bench && !options.isolate && std::any_of(tests.begin(), tests.end(),
+      [&options](const TestCase* t) { return t->timeout_ms(options) > 0; });
+  if (watch) {
+    watchdog::instance().start([&](const TestCase& t, double elapsed, double timeout) {
+      simple_print::colored_cout_line(simple_print::red)
+          << t << " timed out: " << format_ns(elapsed) << " > " << format_ns(timeout) << ", aborting the run";
+      print_summary(tests, finished.get(), &t, num_skipped, num_cached, options, elapsed_ns(run_start));
+      save_cache(&t, finished.get());
+      if (!results.empty()) {
+        results.test(t, false, {{"", 0, "timed out: " + format_ns(elapsed) + " > " + format_ns(timeout)}});
+        results.close(elapsed_ns(run_start));
+      }
+      simple_print::async_writer::instance().flush_on_crash();
+      simple_print::flush_output();
+      _exit(EXIT_FAILURE);
+    });
+  }
+
+  auto run_tests = [&] {
+    if (!async_tests.empty()) {
+      run_async(async_tests, options);
+      for (size_t i = 0; i != tests.size(); ++i) {
+        if (tests[i]->is_async()) finished[i] = true;
+      }
+    }
+    if (options.bench) {
+      for (size_t i = 0; i != tests.size(); ++i) run_one(i);  // one by one, to not disturb measurements
+    } else if (options.isolate && !tests.empty()) {
+      run_isolated(tests, options);
+      for (size_t i = 0; i != tests.size(); ++i) finished[i] = true;
+    } else if (options.jobs > 1 && tests.size() > 1) {
+      if (scheduled) {
+        parallel_for_queues(schedule.queues, run_one);
+      } else {
+        parallel_for(tests.size(), options.jobs, run_one);
+      }
+    } else {
+      for (size_t i = 0; i != tests.size(); ++i) run_one(i);
+    }
+  };
+
+  // --repeat, --until-fail, --repeat-for: the same tests again, in this process
+  const bool repeating = options.repeating() && !options.bench;
+  int iterations = 0;
+  int failed_runs = 0;
+  auto progress_time = run_start;
+  for (;;) {
+    run_tests();
+    ++iterations;
+    if (!repeating) break;
+
+    int failed_now = 0;
+    for (const TestCase* t : tests) failed_now += !t->m_passed;
+    failed_runs += failed_now;
+    const auto now = std::chrono::steady_clock::now();
+    if (now - progress_time >= std::chrono::seconds(1)) {
+      progress_time = now;
+      simple_print::colored_cout_line(simple_print::blue)
+          << "repeated " << iterations << " times, " << failed_runs << " failed runs, " << format_ns(elapsed_ns(run_start));
+      simple_print::flush_output();
+    }
+    if ((options.until_fail && failed_now) ||
+        (options.repeat > 1 && iterations >= options.repeat) ||
+        (options.repeat_for_ms > 0 && elapsed_ns(run_start) >= options.repeat_for_ms * 1e6)) {
+      break;
+    }
+  }
+  // a test which has failed in any iteration is failed; its typical time is the median
+  if (repeating) {
+    for (TestCase* t : tests) {
+      t->m_passed = !t->m_failed_runs;
+      if (!t->m_run_ns.empty()) t->m_wall_ns = benchmark_stats(t->m_run_ns).median;
+    }
+  }
+
+  if (watch) watchdog::instance().stop();
+  if (async_output) simple_print::async_writer::instance().stop();
+
+  const double total_ns = elapsed_ns(run_start);
+  results.close(total_ns);
+  save_cache(nullptr, finished.get());
+  bool passed = print_summary(tests, finished.get(), nullptr, num_skipped, num_cached, options, total_ns);
+  if (const int unowned = unowned_failures().exchange(0)) {
+    simple_print::colored_cout_line(simple_print::red) << "failed in threads of unknown tests: " << unowned;
+    passed = false;
+  }
+  if (repeating) print_repeats(tests, iterations, options);
+  if (scheduled && iterations == 1) schedule.print(tests, workers, total_ns);
+  if (!options.compare_baseline.empty() && !compare_baseline(tests, options)) passed = false;
+  if (!options.save_baseline.empty()) {
+    baseline_file baseline;
+    baseline.load(options.save_baseline);
+    for (const TestCase* t : tests) {
+      if (t->m_called && t->m_passed) baseline.samples[baseline_file::key(*t)] = t->timing_samples();
+    }
+    if (!baseline.save(options.save_baseline)) {
+      std::cerr << "can't write " << options.save_baseline << ": " << strerror(errno) << std::endl;
+    }
+  }
+
+  simple_print::flush_output();
+  simple_print::crash_flusher::uninstall();
+  return passed;
+}
+
+// after a timeout, the tests which have not finished are listed as interrupted
+inline bool TestCase::print_summary(
+    const std::vector<TestCase*>& tests, const std::atomic<bool>* finished, const TestCase* timed_out,
+    int num_skipped, int num_cached, const run_options& options, double total_ns) {
+  std::vector<TestCase*> done, failed, interrupted;
+  for (size_t i = 0; i != tests.size(); ++i) {
+    TestCase* t = tests[i];
+    if (t == timed_out) {
+      failed.push_back(t);
+    } else if (!finished[i]) {
+      interrupted.push_back(t);
+    } else {
+      done.push_back(t);
+      if (!t->m_passed) failed.push_back(t);
+    }
+  }
+  size_t num_passed = tests.size() - failed.size() - interrupted.size();
+
+  simple_print::colored_cout_line(simple_print::normal) << simple_print::barbar;
+  if (num_passed) {
+    simple_print::colored_cout_line(simple_print::green) << "passed:  " << num_passed;
+  }
+  if (!failed.empty()) {
+    simple_print::colored_cout_line(simple_print::red) << "failed:  " << failed.size();
+    for (TestCase* t : failed) {
+      simple_print::colored_cout_line(simple_print::red) << " * " << *t << (t == timed_out ? " (timed out)" : "");
+    }
+  }
+  if (!interrupted.empty()) {
+    simple_print::colored_cout_line(simple_print::yellow) << "interrupted: " << interrupted.size();
+    for (TestCase* t : interrupted) {
+      simple_print::colored_cout_line(simple_print::yellow) << " * " << *t;
+    }
+  }
+
+  if (num_skipped) {
+    simple_print::colored_cout_line(simple_print::blue) << "skipped: " << num_skipped;
+  }
+  if (num_cached) {
+    simple_print::colored_cout_line(simple_print::blue) << "cached:  " << num_cached << " (passed with this binary)";
+  }
+
+  print_timing(done, options, total_ns);
+  return failed.empty() && interrupted.empty();
+}
+
+inline void TestCase::print_timing(const std::vector<TestCase*>& tests, const run_options& options, double total_ns) {
+  double cpu_ns = 0;
+  int num_slow = 0;
+  for (const TestCase* t : tests) {
+    cpu_ns += t->m_cpu_ns;
+    num_slow += t->is_slow(options);
+  }
+  {
+    simple_print::colored_cout_line line(simple_print::normal);
+    line << "time:    " << format_ns(total_ns);
+    if (!options.repeating()) line << " (cpu " << format_ns(cpu_ns) << ")";  // else of the last iteration only
+  }
+  if (allocation_counting()) {
+    uint64_t allocs = 0, bytes = 0;
+    for (const TestCase* t : tests) {
+      allocs += t->m_allocs;
+      bytes += t->m_alloc_bytes;
+    }
+    simple_print::colored_cout_line(simple_print::normal)
+        << "allocs:  " << allocs << " of " << format_si(bytes) << "B";
+  }
+  if (perf_counters::enabled() && !options.bench) {
+    double totals[perf_counter_count];
+    std::fill(std::begin(totals), std::end(totals), NAN);
+    for (const TestCase* t : tests) {
+      for (size_t i = 0; i != perf_counter_count; ++i) {
+        if (!std::isnan(t->m_counters[i])) totals[i] = (std::isnan(totals[i]) ? 0 : totals[i]) + t->m_counters[i];
+      }
+    }
+    simple_print::colored_cout_line line(simple_print::normal);
+    line << "counters:";
+    print_counters(line.ost(), totals);
+  }
+  if (num_slow) {
+    simple_print::colored_cout_line(simple_print::yellow)
+        << "slow:    " << num_slow << " (> " << format_ns(options.slow_threshold_ms * 1e6) << ")";
+  }
+  // repeated tests are listed with the spread of their times, see print_repeats
+  if (options.slowest <= 0 || tests.size() < 2 || options.repeating()) return;
+
+  std::vector<const TestCase*> slowest(tests.begin(), tests.end());
+  size_t n = std::min<size_t>(options.slowest, slowest.size());
+  std::partial_sort(slowest.begin(), slowest.begin() + n, slowest.end(),
+      [](const TestCase* a, const TestCase* b) { return a->m_wall_ns > b->m_wall_ns; });
+  simple_print::colored_cout_line(simple_print::normal) << "slowest tests:";
+  for (size_t i = 0; i != n; ++i) {
+    const TestCase* t = slowest[i];
+    auto color = t->is_slow(options) ? simple_print::yellow : simple_print::normal;
+    simple_print::colored_cout_line(color) << std::setw(10) << format_ns(t->m_wall_ns) << "  " << *t;
+  }
+
+  struct suite_time { double wall_ns = 0; int count = 0; };
+  std::map<std::string_view, suite_time> suites;
+  for (const TestCase* t : tests) {
+    auto& st = suites[t->m_suite];
+    st.wall_ns += t->m_wall_ns;
+    st.count++;
+  }
+  if (suites.size() < 2) return;
+  std::vector<std::pair<std::string_view, suite_time>> by_time(suites.begin(), suites.end());
+  n = std::min<size_t>(options.slowest, by_time.size());
+  std::partial_sort(by_time.begin(), by_time.begin() + n, by_time.end(),
+      [](const auto& a, const auto& b) { return a.second.wall_ns > b.second.wall_ns; });
+  simple_print::colored_cout_line(simple_print::normal) << "slowest suites:";
+  for (size_t i = 0; i != n; ++i) {
+    simple_print::colored_cout_line(simple_print::normal)
+        << std::setw(10) << format_ns(by_time[i].second.wall_ns) << "  " << by_time[i].first
+        << " (" << by_time[i].second.count << " tests)";
+  }
+}
+
+// after --repeat: flaky tests with their failure counts, and the spread of times
+// of the slowest tests and of the ones with outliers (a run longer than 3 medians, by 0.1 ms at least)
+inline void TestCase::print_repeats(const std::vector<TestCase*>& tests, int iterations, const run_options& options) {
+  simple_print::colored_cout_line(simple_print::normal) << "repeated: " << iterations << " times";
+  int num_always_failed = 0;
+  for (const TestCase* t : tests) {
+    if (t->m_failed_runs && t->m_failed_runs < t->m_runs) {
+      simple_print::colored_cout_line(simple_print::yellow)
+          << "flaky:   " << *t << " failed " << t->m_failed_runs << " of " << t->m_runs << " runs";
+    }
+    num_always_failed += t->m_runs && t->m_failed_runs == t->m_runs;
+  }
+  if (num_always_failed) {
+    simple_print::colored_cout_line(simple_print::red) << "failed in every run: " << num_always_failed;
+  }
+  if (options.slowest <= 0) return;
+
+  struct spread {
+    const TestCase* test;
+    double min, median, p90, max;
+  };
+  std::vector<spread> spreads;
+  for (const TestCase* t : tests) {
+    if (t->m_run_ns.empty()) continue;
+    std::vector<double> times = t->m_run_ns;
+    std::sort(times.begin(), times.end());
+    const size_t p90 = (times.size() * 9 + 9) / 10 - 1;  // nearest rank
+    spreads.push_back({t, times.front(), benchmark_stats(times).median, times[p90], times.back()});
+  }
+  auto print = [&](const char* title, std::vector<spread> items, auto order, auto color) {
+    if (items.empty()) return;
+    size_t n = std::min<size_t>(options.slowest, items.size());
+    std::partial_sort(items.begin(), items.begin() + n, items.end(), order);
+    simple_print::colored_cout_line(simple_print::normal) << title;
+    for (size_t i = 0; i != n; ++i) {
+      const spread& s = items[i];
+      simple_print::colored_cout_line(color(s))
+          << std::setw(10) << format_ns(s.min) << std::setw(10) << format_ns(s.median)
+          << std::setw(10) << format_ns(s.p90) << std::setw(10) << format_ns(s.max) << "  " << *s.test;
+    }
+  };
+  auto is_outlier = [](const spread& s) { return s.max > 3 * s.median && s.max - s.median > 1e5; };
+  print("slowest tests (min, median, p90, max):", spreads,
+      [](const spread& a, const spread& b) { return a.median > b.median; },
+      [&](const spread& s) { return is_outlier(s) ? simple_print::yellow : simple_print::normal; });
+  std::vector<spread> outliers;
+  std::copy_if(spreads.begin(), spreads.end(), std::back_inserter(outliers), is_outlier);
+  print("outliers (a run longer than 3 medians):", outliers,
+      [](const spread& a, const spread& b) { return a.max / a.median > b.max / b.median; },
+      [](const spread&) { return simple_print::yellow; });
+}
+
+// what a baseline keeps of a test: ns per iteration of a benchmark, or the time of each run of a test
+inline std::vector<double> TestCase::timing_samples() const {
+  if (is_benchmark()) return m_bench_samples;
+  if (!m_run_ns.empty()) return m_run_ns;
+  return {m_wall_ns};
+}
+
+// a test is slower than in the baseline if its median has grown by more than the threshold,
+// and the samples are significantly greater by the Mann-Whitney U test (so noise does not fail the run)
+inline bool TestCase::compare_baseline(const std::vector<TestCase*>& tests, const run_options& options) {
+  baseline_file baseline;
+  if (!baseline.load(options.compare_baseline)) {
+    simple_print::colored_cout_line(simple_print::yellow)
+        << "no baseline in " << options.compare_baseline << ", nothing to compare with";
+    return true;
+  }
+  static constexpr size_t min_samples = 3;  // fewer can't be significant at p < 0.05
+
+  struct change {
+    const TestCase* test;
+    double before, after, percent, p;
+    bool slower, faster;
+  };
+  std::vector<change> changes;
+  int num_new = 0, num_few = 0;
+  for (const TestCase* t : tests) {
+    if (!t->m_called || !t->m_passed) continue;
+    const std::vector<double>* before = baseline.find(*t);
+    if (!before) {
+      num_new++;
+      continue;
+    }
+    const std::vector<double> after = t->timing_samples();
+    if (before->size() < min_samples || after.size() < min_samples) {
+      num_few++;
+      continue;
+    }
+    change c{t, benchmark_stats(*before).median, benchmark_stats(after).median, 0, 0, false, false};
+    c.percent = c.before > 0 ? (c.after / c.before - 1) * 100 : 0;
+    const double p_slower = mann_whitney_p(*before, after);
+    const double p_faster = mann_whitney_p(after, *before);
+    c.p = std::min(p_slower, p_faster);
+    c.slower = p_slower < options.significance && c.percent > options.regression_threshold;
+    c.faster = p_faster < options.significance && c.percent < -options.regression_threshold;
+    changes.push_back(c);
+  }
+  std::sort(changes.begin(), changes.end(), [](const change& a, const change& b) { return a.percent > b.percent; });
+
+  int num_slower = 0;
+  simple_print::colored_cout_line(simple_print::normal)
+      << "compared with the baseline " << options.compare_baseline << " (median before, after, change, p-value):";
+  for (const change& c : changes) {
+    num_slower += c.slower;
+    auto color = c.slower ? simple_print::red : c.faster ? simple_print::green : simple_print::normal;
+    simple_print::colored_cout_line line(color);
+    line << std::setw(10) << format_ns(c.before) << std::setw(10) << format_ns(c.after)
+         << std::setw(9) << std::showpos << std::fixed << std::setprecision(1) << c.percent << "%"
+         << std::noshowpos << std::setw(9) << std::setprecision(4) << c.p << std::defaultfloat
+         << (c.slower ? "  slower " : c.faster ? "  faster " : "         ") << " " << *c.test;
+  }
+  if (num_new) simple_print::colored_cout_line(simple_print::normal) << "not in the baseline: " << num_new;
+  if (num_few) {
+    simple_print::colored_cout_line(simple_print::normal)
+        << "too few samples to compare: " << num_few << " (at least " << min_samples
+        << ", see --repeat and --bench-samples)";
+  }
+  if (num_slower) {
+    simple_print::colored_cout_line(simple_print::red)
+        << "slower than the baseline by more than " << options.regression_threshold << "%: " << num_slower;
+  }
+  return !num_slower;
+}
+
+inline const test_registry& test_registry::instance() {
+  static test_registry r;
+  if (!r.m_built || r.m_size != TestCase::count()) r.build();
+  return r;
+}
+
+inline void test_registry::build() {
+  param_instantiation::expand_all();
+
+  tests.clear();
+  suites.clear();
+  suite_index.clear();
+  m_size = TestCase::count();
+  m_built = true;
+
+  // counting sort by suite, which keeps the order of registration within a suite
+  std::vector<uint32_t> suite_of;
+  for (TestCase* t = TestCase::first(); t; t = t->m_next) {
+    auto [it, added] = suite_index.try_emplace(t->m_suite, suites.size());
+    if (added) suites.push_back(suite{t->m_suite, 0, 0});
+    suite_of.push_back(static_cast<uint32_t>(it->second));
+    suites[it->second].end++;  // count for now
+  }
+  size_t offset = 0;
+  for (suite& s : suites) {
+    s.begin = offset;
+    offset += s.end;
+    s.end = s.begin;
+  }
+  tests.resize(offset);
+  size_t i = 0;
+  for (TestCase* t = TestCase::first(); t; t = t->m_next) {
+    tests[suites[suite_of[i++]].end++] = t;
+  }
+}
+
+inline const test_registry::suite* test_registry::find(std::string_view suite_name) const {
+  auto it = suite_index.find(suite_name);
+  return it == suite_index.end() ? nullptr : &suites[it->second];
+}
+
+inline TestCase* test_registry::find(std::string_view suite_name, std::string_view test_name) const {
+  const suite* s = find(suite_name);
+  if (!s) return nullptr;
+  for (size_t i = s->begin; i != s->end; ++i) {
+    if (tests[i]->m_name == test_name) return tests[i];
+  }
+  return nullptr;
+}
+
+// the instantiation has failed to make its generator
+struct broken_param_source : param_source_base {
+  std::string what;
+  size_t size() const override { return 1; }
+  static void run(const param_source_base& source, size_t) {
+    throw std::runtime_error(static_cast<const broken_param_source&>(source).what);
+  }
+};
+
+inline void param_instantiation::expand() {
+  if (m_expanded) return;
+  m_expanded = true;
+
+  std::vector<const param_test*> patterns;
+  for (const param_test* p = param_test::first(); p; p = p->m_next) {
+    if (strcmp(p->m_suite, m_suite) == 0) patterns.push_back(p);
+  }
+  if (patterns.empty()) return;
+
+  static std::deque<broken_param_source> broken;  // they live as long as the tests
+  const param_source_base* source = nullptr;
+  bool broken_source = false;
+  size_t n = 0;
+  try {
+    source = &m_source();
+    n = source->size();
+  } catch (const std::exception& e) {
+    broken.emplace_back();
+    broken.back().what = std::string("can't make parameters: ") + e.what();
+    source = &broken.back();
+    broken_source = true;
+    n = 1;
+  }
+
+  // names: "prefix/suite" and "name/index" for each pattern and index, in one block
+  const size_t index_len = std::to_string(n).size() + 1;  // with '\0'
+  size_t total = strlen(m_prefix) + 1 + strlen(m_suite) + 1;
+  for (const param_test* p : patterns) total += (strlen(p->m_name) + 1 + index_len) * n;
+  m_names.reset(new char[total]);
+  char* out = m_names.get();
+  const char* suite = out;
+  out += sprintf(out, "%s/%s", m_prefix, m_suite) + 1;
+
+  m_tests.reserve(patterns.size() * n);  // so the instances don't move
+  for (const param_test* p : patterns) {
+    bool enabled = !TestCase::is_name_disabled(m_prefix) &&
+        !TestCase::is_name_disabled(m_suite) && !TestCase::is_name_disabled(p->m_name);
+    param_test_func func = broken_source ? broken_param_source::run : p->m_func;
+    for (size_t i = 0; i != n; ++i) {
+      const char* name = out;
+      out += sprintf(out, "%s/%zu", p->m_name, i) + 1;
+      m_tests.emplace_back(suite, name, func, *source, i, enabled);
+    }
+  }
+}
+
+inline void param_instantiation::expand_all() {
+  for (param_instantiation* inst = first(); inst; inst = inst->m_next) inst->expand();
+}
+
+inline void show_help(const char* app) {
+  OUTPUT_STREAM()
+    << "Usage: " << app << " [-h|--help] [-l|--list] [-j|--jobs N] [--isolate] [--async-output]"
+       " [--timeout=MS] [--slowest=N] [--slow-threshold=MS]"
+       " [--bench [--bench-samples=N] [--bench-time=MS]]"
+       " [--output=xml:PATH|json:PATH] [--cache=PATH|--no-cache] [--order=longest-first|declared]"
+       " [--shard=I/N] [--failed-first] [--only-changed] [--counters[=NAMES]]"
+       " [--repeat=N] [--until-fail] [--repeat-for=DURATION]"
+       " [--save-baseline=PATH] [--compare-baseline=PATH] [--regression-threshold=PCT] [--significance=P]"
+       " [--print-width=N]"
+       " [--seed=N] [--property-cases=N] [--property-jobs=N] {patterns}" << std::endl
+    << "  -h | --help  - print help" << std::endl
+    << "  -l | --list  - print list of matched tests, instead of run them" << std::endl
+    << "  -j | --jobs N - run tests on N threads (0 - on all cores)" << std::endl
+    << "  --isolate    - run tests in child processes, so a crash fails only one test" << std::endl
+    << "                 (with --jobs, in N child processes)" << std::endl
+    << "  --async-output - write the output on a separate thread" << std::endl
+    << "  --timeout=MS - default timeout of a test; a hung test aborts the run" << std::endl
+    << "                 (with --isolate, it is killed and the run goes on)" << std::endl
+    << "  --slowest=N  - report N slowest tests and suites (5 by default, 0 - none)" << std::endl
+    << "  --slow-threshold=MS - highlight tests which run longer than MS" << std::endl
+    << "  --bench      - run (or list) benchmarks instead of tests, one by one" << std::endl
+    << "  --bench-samples=N - number of measurements of each benchmark (10 by default)" << std::endl
+    << "  --bench-time=MS - duration of each measurement (50 ms by default)" << std::endl
+    << "  --output=xml:PATH | --output=json:PATH - write results to a file, as GTest does;" << std::endl
+    << "                 each test is written when it finishes (may be repeated)" << std::endl
+    << "  --cache=PATH - where to keep results of previous runs (the program path + .cache by default)" << std::endl
+    << "  --no-cache   - do not use (nor update) the results of previous runs" << std::endl
+    << "  --order=longest-first|declared - order of tests in parallel runs and shards:" << std::endl
+    << "                 by durations of previous runs (by default), or as they are declared" << std::endl
+    << "  --shard=I/N  - run only the I-th of N parts of the tests (0 <= I < N)" << std::endl
+    << "  --failed-first - run the tests which failed last time first" << std::endl
+    << "  --only-changed - skip the tests which have passed with this very binary" << std::endl
+    << "  --counters[=NAMES] - read performance counters around each test (Linux perf events):" << std::endl
+    << "                 comma-separated instructions, cycles, cache-misses, branch-misses," << std::endl
+    << "                 context-switches, page-faults (all by default)" << std::endl
+    << "  --repeat=N   - run the tests N times in this process, showing only the first failure" << std::endl
+    << "                 of each test, then failure counts and the spread of times" << std::endl
+    << "  --until-fail - repeat the tests until some of them fails" << std::endl
+    << "  --repeat-for=DURATION - repeat the tests for a while, e.g. 30s, 500ms, 10m, 1h" << std::endl
+    << "  --save-baseline=PATH - keep timings of the passed tests (or benchmarks) to compare with later" << std::endl
+    << "  --compare-baseline=PATH - compare timings with the saved ones; the run fails if a test is" << std::endl
+    << "                 significantly slower (Mann-Whitney U test) by more than the threshold" << std::endl
+    << "  --regression-threshold=PCT - slowdown of the median which is tolerated (5% by default)" << std::endl
+    << "  --significance=P - p-value below which a slowdown is not noise (0.05 by default)" << std::endl
+    << "  --print-width=N - print at most N characters of a failed value (200 by default, 0 - all)" << std::endl
+    << "  --seed=N     - seed of random cases of properties (random by default)" << std::endl
+    << "  --property-cases=N - number of random cases of each property (100 by default)" << std::endl
+    << "  --property-jobs=N - check cases of a property on N threads (0 - on all cores)" << std::endl
+    << "  patterns     - names of tests to run (if not set, will run all)" << std::endl
+    << "  -pattern     - names of tests to exclude" << std::endl
+    << "  patterns are glob-like:" << std::endl
+    << "    ? for any single char," << std::endl
+    << "    * for any substring," << std::endl
+    << "    . is a suite.name separator" << std::endl
+    << "    / is a separator in names of parameterized tests: prefix/suite.name/index" << std::endl
+    << "    valid chars are a-z, A-Z, 0-9, _" << std::endl
+    << std::endl;
+  simple_print::flush_output();
+}
+
+inline void show_list(auto filter, bool bench = false) {
+  for (TestCase* t : test_registry::instance().tests) {
+    if (t->is_benchmark() == bench && filter(t->m_suite, t->m_name)) {
+      OUTPUT_STREAM() << *t << std::endl;
+    }
+  }
+  simple_print::flush_output();
+}
+
+// Set of glob patterns compiled into one automaton.
+// A test is selected if it matches any of positive patterns (or there are none)
+// and matches none of negative patterns.
+//
+// Each pattern of n tokens ('*', '?' or a char) owns n+1 states of NFA,
+// state k means "first k tokens are matched".
+// All the states are simulated at once as a bit set (Shift-And algorithm):
+// a char moves the states of '?' and of the same char one bit left,
+// and the states of '*' stay where they are.
+struct glob_filter {
+  using word = uint64_t;
+  static constexpr size_t word_bits = 64;
+
+  static bool is_valid(std::string_view pattern) {
+    return std::all_of(pattern.begin(), pattern.end(), [](char c) {
+      return isalnum(static_cast<unsigned char>(c)) || strchr("_.*?/", c);
+    });
+  }
+
+  void add(std::string_view pattern, bool negative = false) {
+    std::string tokens;
+    for (char c : pattern) {
+      if (c == '*' && !tokens.empty() && tokens.back() == '*') continue;  // ** is *
+      tokens += c;
+    }
+    (negative ? m_num_negative : m_num_positive)++;
+
+    size_t first = m_num_states;
+    m_num_states += tokens.size() + 1;
+    resize((m_num_states + word_bits - 1) / word_bits);
+
+    set(m_start, first);
+    set(negative ? m_negative_final : m_positive_final, first + tokens.size());
+    for (size_t k = 0; k != tokens.size(); ++k) {
+      char c = tokens[k];
+      size_t state = first + k;
+      if (c == '*') {
+        set(m_star, state);
+      } else {
+        for (int x = 0; x != 256; ++x) {
+          if (c == '?' || x == static_cast<unsigned char>(c)) set(m_chars, x * m_start.size(), state);
+        }
+      }
+    }
+  }
+
+  bool empty() const { return !m_num_positive && !m_num_negative; }
+
+  // matches "suite.name" without composing it
+  bool operator()(const char* suite, const char* name) const {
+    if (empty()) return true;
+
+    // usually there are few patterns, so the states fit into a few words on stack
+    switch (m_start.size()) {
+      case 1: return match<1>(suite, name);
+      case 2: return match<2>(suite, name);
+      case 3: return match<3>(suite, name);
+      case 4: return match<4>(suite, name);
+      default: return match<0>(suite, name);
+    }
+  }
+
+private:
+  size_t m_num_states = 0;
+  size_t m_num_positive = 0;
+  size_t m_num_negative = 0;
+  std::vector<word> m_start, m_positive_final, m_negative_final, m_star;
+  // 256 bit sets, one per char: the states which advance on the char
+  std::vector<word> m_chars;
+
+  void resize(size_t n) {
+    size_t old_n = m_start.size();
+    if (n == old_n) return;
+    for (auto* v : {&m_start, &m_positive_final, &m_negative_final, &m_star}) v->resize(n);
+    std::vector<word> chars(256 * n);
+    for (size_t x = 0; x != 256 && old_n; ++x) {
+      std::copy_n(m_chars.begin() + x * old_n, old_n, chars.begin() + x * n);
+    }
+    m_chars.swap(chars);
+  }
+
+  static void set(std::vector<word>& bits, size_t offset, size_t i) {
+    bits[offset + i / word_bits] |= word(1) << (i % word_bits);
+  }
+  static void set(std::vector<word>& bits, size_t i) { set(bits, 0, i); }
+
+  // N is a number of words, or 0 if it is not known at compile time
+  template<size_t N> bool match(const char* suite, const char* name) const {
+    const size_t n = N ? N : m_start.size();
+    word local[N ? 3 * N : 1];
+    thread_local std::vector<word> scratch;
+    if (!N) scratch.resize(3 * n);
+    word* cur = N ? local : scratch.data();
+    word* tmp = cur + n;
+    word* star = tmp + n;
+    std::copy_n(m_star.begin(), n, star);
+
+    // tmp = (tmp << 1) over all the words
+    auto shift = [n, tmp]() {
+      word carry = 0;
+      for (size_t w = 0; w != n; ++w) {
+        word x = tmp[w];
+        tmp[w] = (x << 1) | carry;
+        carry = x >> (word_bits - 1);
+      }
+    };
+    // '*' may match an empty string, so its successor state is active too
+    auto skip_stars = [&]() {
+      for (size_t w = 0; w != n; ++w) tmp[w] = cur[w] & star[w];
+      shift();
+      for (size_t w = 0; w != n; ++w) cur[w] |= tmp[w];
+    };
+    // returns false if no states remain active
+    auto step = [&](char c) {
+      const word* chars = m_chars.data() + static_cast<unsigned char>(c) * n;
+      for (size_t w = 0; w != n; ++w) tmp[w] = cur[w] & chars[w];
+      shift();
+      word alive = 0;
+      for (size_t w = 0; w != n; ++w) {
+        cur[w] = tmp[w] | (cur[w] & star[w]);
+        alive |= cur[w];
+      }
+      skip_stars();
+      return alive != 0;
+    };
+    auto intersects = [&](const std::vector<word>& bits) {
+      word common = 0;
+      for (size_t w = 0; w != n; ++w) common |= cur[w] & bits[w];
+      return common != 0;
+    };
+
+    std::copy_n(m_start.begin(), n, cur);
+    skip_stars();
+    bool alive = true;
+    for (const char* s = suite; alive && *s; ++s) alive = step(*s);
+    alive = alive && step('.');
+    for (const char* s = name; alive && *s; ++s) alive = step(*s);
+
+    bool positive = !m_num_positive || (alive && intersects(m_positive_final));
+    bool negative = alive && intersects(m_negative_final);
+    return positive && !negative;
+  }
+};
+
+// matches an option with a value: "-s VALUE", "-sNUMBER", "--long VALUE", "--long=VALUE"
+// (the value may be taken from the next argument)
+inline bool parse_option_value(
+    int argc, char** argv, int& i,
+    const char* short_opt, const char* long_opt,
+    const char*& value) {
+  const char* arg = argv[i];
+  size_t n;
+  if (short_opt && strncmp(arg, short_opt, n = strlen(short_opt)) == 0) {
+    if (arg[n] && strspn(arg + n, "0123456789") != strlen(arg + n)) return false;
+    if (arg[n]) { value = arg + n; return true; }
+  } else if (long_opt && strncmp(arg, long_opt, n = strlen(long_opt)) == 0) {
+    if (arg[n] == '=') { value = arg + n + 1; return true; }
+    if (arg[n]) return false;
+  } else {
+    return false;
+  }
+  if (i + 1 >= argc) return false;
+  value = argv[++i];
+  return true;
+}
+
+// "1.5s", "500ms", "10m", "1h" (seconds if no unit) -> milliseconds; 0 if invalid
+inline double parse_duration_ms(const char* text) {
+  char* end = nullptr;
+  const double value = strtod(text, &end);
+  if (end == text || !(value > 0)) return 0;
+  static const std::pair<const char*, double> units[] = {{"", 1e3}, {"s", 1e3}, {"ms", 1}, {"m", 60e3}, {"h", 3600e3}};
+  for (const auto& [unit, ms] : units) {
+    if (strcmp(end, unit) == 0) return value * ms;
+  }
+  return 0;
+}
+
+// "cycles,instructions" -> mask of perf_counters::names
+inline bool parse_counters(std::string_view names, unsigned& mask) {
+  mask = 0;
+  while (!names.empty()) {
+    std::string_view name = names.substr(0, names.find(','));
+    names.remove_prefix(std::min(names.size(), name.size() + 1));
+    auto it = std::find(std::begin(perf_counters::names), std::end(perf_counters::names), name);
+    if (it == std::end(perf_counters::names)) return false;
+    mask |= 1u << (it - std::begin(perf_counters::names));
+  }
+  return mask != 0;
+}
+
+inline int testing_main(int argc, char** argv) {
+  glob_filter filter;
+
+  bool list = false;
+  run_options options;
+  options.cache_path = std::string(argv[0]) + ".cache";
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = nullptr;
+    if (arg[0] == '-') {
+      if (strcmp(arg, "-h")==0 || strcmp(arg, "--help")==0) {
+        show_help(argv[0]);
+        return 0;
+      } else if (strcmp(arg, "-l")==0 || strcmp(arg, "--list")==0) {
+        list = true;
+      } else if (parse_option_value(argc, argv, i, "-j", "--jobs", value)) {
+        options.jobs = atoi(value);
+        if (options.jobs <= 0) options.jobs = std::max(1u, std::thread::hardware_concurrency());
+      } else if (strcmp(arg, "--isolate")==0) {
+        options.isolate = true;
+      } else if (strcmp(arg, "--async-output")==0) {
+        options.async_output = true;
+      } else if (strcmp(arg, "--bench")==0) {
+        options.bench = true;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--timeout", value)) {
+        options.timeout_ms = atof(value);
+      } else if (parse_option_value(argc, argv, i, nullptr, "--slowest", value)) {
+        options.slowest = atoi(value);
+      } else if (parse_option_value(argc, argv, i, nullptr, "--slow-threshold", value)) {
+        options.slow_threshold_ms = atof(value);
+      } else if (parse_option_value(argc, argv, i, nullptr, "--bench-samples", value)) {
+        options.bench_samples = std::max(1, atoi(value));
+      } else if (parse_option_value(argc, argv, i, nullptr, "--bench-time", value)) {
+        options.bench_sample_ms = std::max(1.0, atof(value));
+      } else if (parse_option_value(argc, argv, i, nullptr, "--output", value)) {
+        options.outputs.push_back(value);
+      } else if (parse_option_value(argc, argv, i, nullptr, "--cache", value)) {
+        options.cache_path = value;
+      } else if (strcmp(arg, "--no-cache")==0) {
+        options.cache_path.clear();
+      } else if (parse_option_value(argc, argv, i, nullptr, "--order", value)) {
+        if (strcmp(value, "declared") != 0 && strcmp(value, "longest-first") != 0) {
+          OUTPUT_STREAM() << "Unknown order " << value << std::endl;
+          return 1;
+        }
+        options.longest_first = strcmp(value, "longest-first") == 0;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--shard", value)) {
+        if (sscanf(value, "%d/%d", &options.shard_index, &options.shard_count) != 2 ||
+            options.shard_count < 1 || options.shard_index < 0 || options.shard_index >= options.shard_count) {
+          OUTPUT_STREAM() << "Invalid shard " << value << ", I/N expected, 0 <= I < N" << std::endl;
+          return 1;
+        }
+      } else if (strcmp(arg, "--failed-first")==0) {
+        options.failed_first = true;
+      } else if (strcmp(arg, "--only-changed")==0) {
+        options.only_changed = true;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--repeat", value)) {
+        options.repeat = std::max(1, atoi(value));
+      } else if (strcmp(arg, "--until-fail")==0) {
+        options.until_fail = true;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--repeat-for", value)) {
+        options.repeat_for_ms = parse_duration_ms(value);
+        if (options.repeat_for_ms <= 0) {
+          OUTPUT_STREAM() << "Invalid duration " << value << ", e.g. 30s, 500ms, 10m, 1h expected" << std::endl;
+          return 1;
+        }
+      } else if (strcmp(arg, "--counters")==0) {
+        options.counters = (1u << perf_counter_count) - 1;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--counters", value)) {
+        if (!parse_counters(value, options.counters)) {
+          OUTPUT_STREAM() << "Unknown counters " << value << ", expected a comma-separated list of:";
+          for (const char* name : perf_counters::names) OUTPUT_STREAM() << " " << name;
+          OUTPUT_STREAM() << std::endl;
+          return 1;
+        }
+      } else if (parse_option_value(argc, argv, i, nullptr, "--save-baseline", value)) {
+        options.save_baseline = value;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--compare-baseline", value)) {
+        options.compare_baseline = value;
+      } else if (parse_option_value(argc, argv, i, nullptr, "--regression-threshold", value)) {
+        options.regression_threshold = std::max(0.0, atof(value));
+      } else if (parse_option_value(argc, argv, i, nullptr, "--significance", value)) {
+        options.significance = atof(value);
+        if (options.significance <= 0 || options.significance >= 1) {
+          OUTPUT_STREAM() << "Invalid significance " << value << ", 0 < P < 1 expected" << std::endl;
+          return 1;
+        }
+      } else if (parse_option_value(argc, argv, i, nullptr, "--print-width", value)) {
+        simple_print::max_print_width() = static_cast<size_t>(std::max(0, atoi(value)));
+      } else if (parse_option_value(argc, argv, i, nullptr, "--seed", value)) {
+        property_settings().seed = strtoull(value, nullptr, 10);
+      } else if (parse_option_value(argc, argv, i, nullptr, "--property-cases", value)) {
+        property_settings().cases = std::max(1, atoi(value));
+      } else if (parse_option_value(argc, argv, i, nullptr, "--property-jobs", value)) {
+        property_settings().jobs = atoi(value);
+        if (property_settings().jobs <= 0) {
+          property_settings().jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+      } else if (arg[1] && arg[1] != '-' && glob_filter::is_valid(arg + 1)) {
+        filter.add(arg + 1, true);
+      } else {
+        OUTPUT_STREAM() << "Unknown option " << arg << std::endl;
+        show_help(argv[0]);
+        return 1;
+      }
+    } else {
+      if (!glob_filter::is_valid(arg)) {
+        OUTPUT_STREAM() << "Invalid pattern " << arg << std::endl;
+      }
+      filter.add(arg);
+    }
+  }
+
+  if (list) {
+    show_list(filter, options.bench);
+    return 0;
+  }
+
+  // the same seed in all the threads and child processes, to be reported
+  property_options& properties = property_settings();
+  if (!properties.seed) {
+    properties.seed = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) % 1000000000 + 1;
+  }
+  properties.parallel_for = [](size_t count, int jobs, void (*func)(void*, size_t), void* context) {
+    parallel_for(count, jobs, [func, context](size_t i) { func(context, i); });
+  };
+
+  return !simple_test::TestCase::run_all(filter, options);
+}
+
+}  // namespace simple_test
+
+// Define SIMPLE_TEST_COUNT_ALLOCATIONS where the runner is included (in one file only)
+// to replace the global operator new and delete with ones which count allocations of each test.
+#ifdef SIMPLE_TEST_COUNT_ALLOCATIONS
+
+#include <malloc.h>
+#include <new>
+
+namespace simple_test::allocation_hooks {
+
+[[maybe_unused]] static const bool counting = (allocation_counting() = true);
+
+inline void* counted(void* p) {
+  if (p) {
+    allocation_counters& c = thread_allocations();
+    const size_t size = malloc_usable_size(p);
+    c.allocs++;
+    c.bytes += size;
+    c.live += size;
+    if (c.live > c.peak) c.peak = c.live;
+  }
+  return p;
+}
+
+inline void release(void* p) {
+  if (!p) return;
+  allocation_counters& c = thread_allocations();
+  c.frees++;
+  c.live -= malloc_usable_size(p);
+  free(p);
+}
+
+inline void* allocate(size_t size) {
+  for (;;) {
+    if (void* p = counted(malloc(size ? size : 1))) return p;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+inline void* allocate(size_t size, std::align_val_t alignment) {
+  const size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+  for (;;) {
+    void* p = nullptr;
+    if (posix_memalign(&p, align, size ? size : 1) == 0) return counted(p);
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+template<class... Args> void* allocate_nothrow(size_t size, Args... args) noexcept {
+  try {
+    return allocate(size, args...);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+}  // namespace simple_test::allocation_hooks
+
+void* operator new(size_t size) { return simple_test::allocation_hooks::allocate(size); }
+void* operator new[](size_t size) { return simple_test::allocation_hooks::allocate(size); }
+void* operator new(size_t size, std::align_val_t a) { return simple_test::allocation_hooks::allocate(size, a); }
+void* operator new[](size_t size, std::align_val_t a) { return simple_test::allocation_hooks::allocate(size, a); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return simple_test::allocation_hooks::allocate_nothrow(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return simple_test::allocation_hooks::allocate_nothrow(size);
+}
+void* operator new(size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+  return simple_test::allocation_hooks::allocate_nothrow(size, a);
+}
+void* operator new[](size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+  return simple_test::allocation_hooks::allocate_nothrow(size, a);
+}
+void operator delete(void* p) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete[](void* p) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete(void* p, size_t) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete[](void* p, size_t) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { simple_test::allocation_hooks::release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  simple_test::allocation_hooks::release(p);
+}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  simple_test::allocation_hooks::release(p);
+}
+
+#endif  // SIMPLE_TEST_COUNT_ALLOCATIONS
+
+#define TESTING_MAIN() \
+    int main(int argc, char** argv) { return simple_test::testing_main(argc, argv); }